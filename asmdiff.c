@@ -0,0 +1,343 @@
+#include "general_header.h"
+#include "asmdiff.h"
+#include "binary_object.h"
+#include "listing.h"
+#include "table.h"
+#include "auxiliary_functions.h"
+#include "errors.h"
+
+
+/* This is the main function of the asmdiff program (see asmdiff.h).
+ * It loads the two outputs, compares the code words, the data words, the entries and the externals,
+ * and prints every difference with the addresses and the decoded fields of the words.
+ */
+int main(int argc, char *argv[])
+{
+    object_image expected, actual;
+    int code_words, data_words, num_of_differences = 0;
+    int strict_order = (argc == 4 && strcmp(argv[1], ASMDIFF_STRICT_ORDER_OPTION) == 0);
+
+    if (argc != 3 + strict_order)
+    {
+        printf("Usage: %s [%s] <expected> <actual>\n", argv[0], ASMDIFF_STRICT_ORDER_OPTION);
+        return ASMDIFF_FAILED;
+    }
+    /* Skip the option => the names are argv[1] and argv[2] */
+    argv += strict_order;
+    if (load_object_image(argv[1], &expected) != ERROR_0)
+        return ASMDIFF_FAILED;
+    if (load_object_image(argv[2], &actual) != ERROR_0)
+    {
+        free_object_image(&expected);
+        return ASMDIFF_FAILED;
+    }
+
+    if (expected.code_words != actual.code_words || expected.data_words != actual.data_words)
+    {/* The common words are still compared */
+        printf("%s: %d code words and %d data words, %s: %d code words and %d data words\n", argv[1], expected.code_words, expected.data_words,
+               argv[2], actual.code_words, actual.data_words);
+        num_of_differences++;
+    }
+    code_words = expected.code_words < actual.code_words ? expected.code_words : actual.code_words;
+    data_words = expected.data_words < actual.data_words ? expected.data_words : actual.data_words;
+    num_of_differences += compare_segment("code", expected.words, actual.words, code_words, INITIAL_IC_VALUE);
+    num_of_differences += compare_segment("data", expected.words + expected.code_words, actual.words + actual.code_words, data_words,
+                                          INITIAL_IC_VALUE + expected.code_words);
+    num_of_differences += compare_symbols("entry", expected.entries, expected.entries_lines, actual.entries, actual.entries_lines, strict_order);
+    num_of_differences += compare_symbols("external", expected.externs, expected.externs_lines, actual.externs, actual.externs_lines, strict_order);
+
+    if (num_of_differences > 0)
+        printf("%s and %s differ\n", argv[1], argv[2]);
+
+    free_object_image(&expected);
+    free_object_image(&actual);
+    return num_of_differences > 0 ? ASMDIFF_DIFFERENT : 0;
+}
+
+int load_object_image(char *name, object_image *image)
+{
+    binary_object object;
+    char *file_name;
+    int i, name_length = strlen(name), extension_length = strlen(BINARY_OBJECT_EXTENSION);
+    int error_number;
+
+    image->words = NULL;
+    image->code_words = image->data_words = 0;
+    image->entries = image->externs = NULL;
+    image->entries_lines = image->externs_lines = 0;
+
+    if (name_length > extension_length && strcmp(name + name_length - extension_length, BINARY_OBJECT_EXTENSION) == 0)
+    {/* Binary object file (the entries and the externals are in the same file) */
+        error_number = load_binary_object(name, &object);
+        if (error_number == ERROR_0)
+        {
+            image->code_words = object.code_words;
+            image->data_words = object.data_words;
+            image->words = safe_malloc((object.code_words + object.data_words + 1) * sizeof(int));  /* +1 for an empty file */
+            for (i = 0; i < object.code_words + object.data_words; i++)
+                image->words[i] = get_binary_object_word(&object, i);
+            copy_binary_symbol_records(object.entry_records, object.entries, &image->entries, &image->entries_lines);
+            copy_binary_symbol_records(object.extern_records, object.externs, &image->externs, &image->externs_lines);
+            free_binary_object(&object);
+        }
+        else
+            print_error(error_number, INTERNAL_ERROR_STAGE);
+        return error_number;
+    }
+
+    /* Text object file, and the entries and externals files */
+    file_name = get_file_name(2, name, ".ob");
+    error_number = load_text_object(file_name, image);
+    free(file_name);
+    if (error_number == ERROR_0)
+    {
+        file_name = get_file_name(2, name, ".ent");
+        error_number = load_symbol_file(file_name, &image->entries, &image->entries_lines);
+        free(file_name);
+    }
+    if (error_number == ERROR_0)
+    {
+        file_name = get_file_name(2, name, ".ext");
+        error_number = load_symbol_file(file_name, &image->externs, &image->externs_lines);
+        free(file_name);
+    }
+    if (error_number != ERROR_0)
+    {
+        free_object_image(image);
+        print_error(error_number, INTERNAL_ERROR_STAGE);
+    }
+    return error_number;
+}
+
+int load_text_object(char *file_name, object_image *image)
+{
+    char line[MAX_LINE_LENGTH];
+    char *end;
+    FILE *file;
+    int i = 0;
+    long address, word;
+
+    file = fopen(file_name, "r");
+    if (file == NULL)
+        return ERROR_2;
+
+    /* The header: the number of code words and the number of data words */
+    if (fgets(line, sizeof(line), file) == NULL || sscanf(line, "%d %d", &image->code_words, &image->data_words) != 2
+        || image->code_words < 0 || image->data_words < 0 || image->code_words + image->data_words > MAX_NUM_OF_WORDS)
+    {
+        fclose(file);
+        return ERROR_49;
+    }
+    image->words = safe_malloc((image->code_words + image->data_words + 1) * sizeof(int));  /* +1 for an empty file */
+
+    while (fgets(line, sizeof(line), file))
+    {/* A line for each word: its address (decimal) and the word (hexadecimal) */
+        address = strtol(line, &end, 10);
+        word = strtol(end, &end, 16);
+        while (IS_OF_CHAR_CLASS(*end, WHITESPACE_CHAR_CLASS))
+            /* Skip the end of the line (including '\r') */
+            end++;
+        if (i == image->code_words + image->data_words || address != INITIAL_IC_VALUE + i || word < 0 || word > BITS_MASK(WORD_SIZE) || *end != '\0')
+        {/* An unexpected line */
+            fclose(file);
+            return ERROR_49;
+        }
+        image->words[i++] = (int)word;
+    }
+    fclose(file);
+
+    /* All the words must be in the file */
+    return i == image->code_words + image->data_words ? ERROR_0 : ERROR_49;
+}
+
+int load_symbol_file(char *file_name, general_table **table, int *lines)
+{
+    char line[MAX_LINE_LENGTH];
+    char *end;
+    FILE *file;
+    int label_length;
+    int capacity = 0;  /* The table is built only here */
+    long address;
+
+    file = fopen(file_name, "r");
+    if (file == NULL)
+        /* No file => no symbols */
+        return ERROR_0;
+
+    while (fgets(line, sizeof(line), file))
+    {/* A line for each symbol: its label and its address */
+        label_length = strcspn(line, " \t\r\n");
+        address = strtol(line + label_length, &end, 10);
+        while (IS_OF_CHAR_CLASS(*end, WHITESPACE_CHAR_CLASS))
+            end++;
+        if (label_length == 0 || label_length > MAX_LABEL_LENGTH || end == line + label_length || *end != '\0')
+        {/* Not a valid line */
+            fclose(file);
+            return ERROR_49;
+        }
+        line[label_length] = '\0';
+        add_to_entries_externs_table(table, (int)address, copy_label(line), lines, &capacity);
+    }
+    fclose(file);
+    return ERROR_0;
+}
+
+void copy_binary_symbol_records(unsigned char *records, int num_of_records, general_table **table, int *lines)
+{
+    int i;
+    int capacity = 0;  /* The table is built only here */
+    for (i = 0; i < num_of_records; i++, records += BINARY_SYMBOL_RECORD_SIZE)
+        add_to_entries_externs_table(table, get_binary_symbol_address(records), copy_label((char *)records), lines, &capacity);
+}
+
+char *copy_label(char *label)
+{
+    char *copy = safe_malloc(strlen(label) + 1);
+    strcpy(copy, label);
+    return copy;
+}
+
+void free_symbol_lines(general_table *table, int lines)
+{
+    int i;
+    for (i = 0; i < lines; i++)
+        free(table[i].label);
+    free(table);
+}
+
+void free_object_image(object_image *image)
+{
+    free(image->words);
+    free_symbol_lines(image->entries, image->entries_lines);
+    free_symbol_lines(image->externs, image->externs_lines);
+    image->words = NULL;
+    image->entries = image->externs = NULL;
+    image->entries_lines = image->externs_lines = 0;
+}
+
+int compare_segment(char *segment_name, int *expected, int *actual, int num_of_words, int first_address)
+{
+    int i = 0, block_end;
+    int range_start = -1;           /* Index of the first word of the current range of different words (-1 if there is none) */
+    int num_of_differences = 0;
+
+    while (i < num_of_words)
+    {
+        block_end = (num_of_words - i < ASMDIFF_BLOCK_WORDS) ? num_of_words : i + ASMDIFF_BLOCK_WORDS;
+        if (range_start == -1 && memcmp(expected + i, actual + i, (block_end - i) * sizeof(int)) == 0)
+        {/* Equal block (most of the blocks) */
+            i = block_end;
+            continue;
+        }
+        for (; i < block_end; i++)
+        {/* Different block (or a range of different words continues into it) => compare word by word */
+            if (expected[i] != actual[i])
+            {
+                if (range_start == -1)
+                    range_start = i;
+                num_of_differences++;
+            }
+            else if (range_start != -1)
+            {/* End of a range */
+                print_different_range(segment_name, expected, actual, range_start, i, first_address);
+                range_start = -1;
+            }
+        }
+    }
+    if (range_start != -1)
+        /* The last range ends with the segment */
+        print_different_range(segment_name, expected, actual, range_start, num_of_words, first_address);
+    return num_of_differences;
+}
+
+void print_different_range(char *segment_name, int *expected, int *actual, int start, int end, int first_address)
+{
+    int i;
+    char expected_fields[LISTING_FIELDS_SIZE], actual_fields[LISTING_FIELDS_SIZE];
+
+    printf("%s words differ at addresses %.7d-%.7d:\n", segment_name, first_address + start, first_address + end - 1);
+    for (i = start; i < end && i < start + ASMDIFF_REPORTED_WORDS; i++)
+    {
+        if (strcmp(segment_name, "code") == 0)
+        {/* An instruction word (an additional word is decoded the same way - its value is in the fields above A,R,E) */
+            describe_first_word(expected_fields, expected[i]);
+            describe_first_word(actual_fields, actual[i]);
+        }
+        else
+        {
+            sprintf(expected_fields, "value %d", decode_signed_value(expected[i], WORD_SIZE));
+            sprintf(actual_fields, "value %d", decode_signed_value(actual[i], WORD_SIZE));
+        }
+        printf("  %.7d  %06x  %s\n", first_address + i, (unsigned)expected[i], expected_fields);
+        printf("  %7s  %06x  %s\n", "", (unsigned)actual[i], actual_fields);
+    }
+    if (end - start > ASMDIFF_REPORTED_WORDS)
+        printf("  ... (%d words)\n", end - start);
+}
+
+int compare_symbols(char *table_name, general_table *expected, int expected_lines, general_table *actual, int actual_lines, int strict_order)
+{
+    int i = 0, j = 0, order, num_of_differences = 0;
+    int first_different_line = 0;              /* Strict order: the first line that differs in the order of the files */
+    int order_differs = 0;
+    general_table expected_line, actual_line;  /* Copies of that line (the tables are sorted below) */
+
+    if (strict_order)
+    {/* Compare the lines in the order of the files */
+        while (first_different_line < expected_lines && first_different_line < actual_lines
+               && compare_symbol_lines(expected + first_different_line, actual + first_different_line) == 0)
+            first_different_line++;
+        if (first_different_line < expected_lines && first_different_line < actual_lines)
+        {
+            expected_line = expected[first_different_line];
+            actual_line = actual[first_different_line];
+            order_differs = 1;
+        }
+    }
+
+    qsort(expected, expected_lines, sizeof(general_table), compare_symbol_lines);
+    qsort(actual, actual_lines, sizeof(general_table), compare_symbol_lines);
+    while (i < expected_lines || j < actual_lines)
+    {/* Merge the sorted tables */
+        if (i == expected_lines)
+            order = 1;
+        else if (j == actual_lines)
+            order = -1;
+        else
+            order = compare_symbol_lines(expected + i, actual + j);
+
+        if (order < 0)
+        {
+            printf("%s %s %.7d is missing\n", table_name, expected[i].label, expected[i].address);
+            i++;
+        }
+        else if (order > 0)
+        {
+            printf("%s %s %.7d is unexpected\n", table_name, actual[j].label, actual[j].address);
+            j++;
+        }
+        else
+        {/* Equal lines */
+            i++;
+            j++;
+            continue;
+        }
+        num_of_differences++;
+    }
+
+    if (order_differs && num_of_differences == 0)
+    {/* The same symbols in a different order */
+        printf("%s line %d: expected %s %.7d, found %s %.7d (the order differs)\n", table_name, first_different_line + 1,
+               expected_line.label, expected_line.address, actual_line.label, actual_line.address);
+        num_of_differences++;
+    }
+    return num_of_differences;
+}
+
+int compare_symbol_lines(const void *first, const void *second)
+{
+    const general_table *first_line = first, *second_line = second;
+    if (first_line->address != second_line->address)
+        return first_line->address < second_line->address ? -1 : 1;
+    return strcmp(first_line->label, second_line->label);
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#ifndef ASMDIFF_H
+#define ASMDIFF_H
+
+
+#include "first_pass.h"
+
+/* The asmdiff program compares the outputs of two assemblies: the object file and the entries and externals files.
+ * Usage: asmdiff [--strict-order] <expected> <actual>
+ * Each argument is a file name without an extension (its ".ob", ".ent" and ".ext" files are loaded; a missing ".ent"/".ext" file is empty),
+ * or a binary object file (a name that ends with BINARY_OBJECT_EXTENSION, that contains the entries and the externals as well).
+ * The words are compared in blocks of ASMDIFF_BLOCK_WORDS words (with memcmp), and only a block that differs is compared word by word.
+ * The entries/externals are compared as sets, unless ASMDIFF_STRICT_ORDER_OPTION is given: then they must be in the same order as well
+ * (the assembler writes them in a fixed order - the entries by their definition, the externals by their address).
+ * The exit status is 0 if the outputs are equal, ASMDIFF_DIFFERENT if they are not, and ASMDIFF_FAILED if a file cannot be loaded.
+ */
+
+#define ASMDIFF_BLOCK_WORDS 256         /** Number of words that are compared with a single memcmp */
+#define ASMDIFF_REPORTED_WORDS 8        /** Maximum number of words that are printed for a range of different words */
+#define ASMDIFF_DIFFERENT 1             /** Exit status when the outputs are different */
+#define ASMDIFF_FAILED 2                /** Exit status when a file cannot be loaded */
+#define ASMDIFF_STRICT_ORDER_OPTION "--strict-order"  /** Command line option: the entries/externals must be in the same order */
+
+/** The outputs of an assembly, loaded to memory */
+typedef struct object_image {
+    int code_words;             /* Number of code words */
+    int data_words;             /* Number of data words */
+    int *words;                 /* The code words (from address INITIAL_IC_VALUE) and then the data words */
+    general_table *entries;     /* The entries table */
+    int entries_lines;
+    general_table *externs;     /* The externs table */
+    int externs_lines;
+} object_image;
+
+
+/**
+ * Loads the outputs of an assembly: a text object file with its entries and externals files, or a binary object file.
+ *
+ * Input:
+ *   - name: The file name without an extension, or the name of a binary object file
+ *   - image: Pointer to the image that is filled (it is freed with free_object_image)
+ *
+ * Output:
+ *   - Returns ERROR_0 if the outputs were loaded, or the error number otherwise (ERROR_2, ERROR_48 or ERROR_49)
+ */
+int load_object_image(char *name, object_image *image);
+
+
+/**
+ * Loads a text object file (".ob"): the header line with the number of code and data words, and a line for each word.
+ * The addresses of the lines must be consecutive (from INITIAL_IC_VALUE).
+ *
+ * Input:
+ *   - file_name: The name of the file
+ *   - image: Pointer to the image whose words are filled
+ *
+ * Output:
+ *   - Returns ERROR_0 if the file was loaded, ERROR_2 if it cannot be opened, or ERROR_49 if it is not a valid object file
+ */
+int load_text_object(char *file_name, object_image *image);
+
+
+/**
+ * Loads an entries/externals file (a line with a label and an address for each symbol). A file that does not exist is an empty table.
+ *
+ * Input:
+ *   - file_name: The name of the file
+ *   - table: Pointer to the table that is filled
+ *   - lines: Pointer to the number of lines in the table
+ *
+ * Output:
+ *   - Returns ERROR_0 if the file was loaded (or does not exist), or ERROR_49 if a line is not valid
+ */
+int load_symbol_file(char *file_name, general_table **table, int *lines);
+
+
+/**
+ * Copies the entry/external records of a binary object file to a table.
+ *
+ * Input:
+ *   - records: The records (BINARY_SYMBOL_RECORD_SIZE bytes each)
+ *   - num_of_records: Number of records
+ *   - table: Pointer to the table that is filled
+ *   - lines: Pointer to the number of lines in the table
+ *
+ * Output:
+ *   - No return value
+ */
+void copy_binary_symbol_records(unsigned char *records, int num_of_records, general_table **table, int *lines);
+
+
+/**
+ * Copies a label name to a new string.
+ *
+ * Input:
+ *   - label: The label name
+ *
+ * Output:
+ *   - Returns a pointer to the copy (allocated dynamically)
+ */
+char *copy_label(char *label);
+
+
+/**
+ * Frees an entries/externs table of an image, including its label names.
+ *
+ * Input:
+ *   - table: The table
+ *   - lines: Number of lines in the table
+ *
+ * Output:
+ *   - No return value
+ */
+void free_symbol_lines(general_table *table, int lines);
+
+
+/**
+ * Frees the memory of a loaded image.
+ *
+ * Input:
+ *   - image: Pointer to the image
+ *
+ * Output:
+ *   - No return value
+ */
+void free_object_image(object_image *image);
+
+
+/**
+ * Compares the words of a segment (code or data) of two images, and prints the ranges of addresses that differ.
+ *
+ * Input:
+ *   - segment_name: "code" or "data"
+ *   - expected: The words of the segment in the first image
+ *   - actual: The words of the segment in the second image
+ *   - num_of_words: Number of words to compare
+ *   - first_address: The address of the first word of the segment
+ *
+ * Output:
+ *   - Returns the number of words that differ
+ */
+int compare_segment(char *segment_name, int *expected, int *actual, int num_of_words, int first_address);
+
+
+/**
+ * Prints a range of different words, each word decoded (the fields of an instruction word, or the value of a data word).
+ *
+ * Input:
+ *   - segment_name: "code" or "data"
+ *   - expected: The words of the segment in the first image
+ *   - actual: The words of the segment in the second image
+ *   - start: Index of the first different word
+ *   - end: Index after the last different word
+ *   - first_address: The address of the first word of the segment
+ *
+ * Output:
+ *   - No return value
+ */
+void print_different_range(char *segment_name, int *expected, int *actual, int start, int end, int first_address);
+
+
+/**
+ * Compares the symbols of two entries/externs tables, and prints the symbols that differ.
+ * With strict_order, tables with the same symbols in a different order differ as well (the first line that differs is printed).
+ *
+ * Input:
+ *   - table_name: "entry" or "external"
+ *   - expected: The table of the first image (it is sorted)
+ *   - expected_lines: Number of lines in the first table
+ *   - actual: The table of the second image (it is sorted)
+ *   - actual_lines: Number of lines in the second table
+ *   - strict_order: Non-zero if the order of the lines matters
+ *
+ * Output:
+ *   - Returns the number of differences
+ */
+int compare_symbols(char *table_name, general_table *expected, int expected_lines, general_table *actual, int actual_lines, int strict_order);
+
+
+/**
+ * Compares two lines of an entries/externs table by their address and then by their label (for qsort).
+ *
+ * Input:
+ *   - first: Pointer to the first line
+ *   - second: Pointer to the second line
+ *
+ * Output:
+ *   - Returns a negative number, zero or a positive number if the first line is before, equal to or after the second line
+ */
+int compare_symbol_lines(const void *first, const void *second);
+
+
+#endif /* ASMDIFF_H */
\ No newline at end of file
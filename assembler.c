@@ -6,13 +6,46 @@
 /* This is the main function of the assembler program.
  * It processes each file passed as a command line argument.
  * For each file, it performs the pre-assembler stage, the first and second pass stages.
+ * Arguments that start with "--" are options, and they apply to all the files:
+ *   --single-pass   Resolve the label operands during the first pass (the second pass only handles data and external labels)
+ *   --format=bin    Write a binary object file (".obj", see binary_object.h) instead of the text object file (--format=text)
+ *   --listing       Write a listing file (".lst"): each source line with its addresses, its words and their fields
+ *   --stream        Less memory: single pass, the data words and the final code words are written during the first pass, and the peak memory is reported
  */
 int main(int argc, char *argv[])
 {
     int i;
+    assembler_options options = {0};
+
+    for (i = 1; i < argc; i++)
+    {/* Read the options first (they apply to all the files, wherever they appear) */
+        if (strncmp(argv[i], "--", 2) != 0)
+            continue;
+        if (strcmp(argv[i], SINGLE_PASS_OPTION) == 0)
+            options.single_pass = 1;
+        else if (strcmp(argv[i], LISTING_OPTION) == 0)
+            options.listing = 1;
+        else if (strcmp(argv[i], STREAM_OPTION) == 0)
+            options.stream = 1;
+        else if (strncmp(argv[i], FORMAT_OPTION, strlen(FORMAT_OPTION)) == 0 && strcmp(argv[i] + strlen(FORMAT_OPTION), "bin") == 0)
+            options.object_format = BINARY_OBJECT_FORMAT;
+        else if (strncmp(argv[i], FORMAT_OPTION, strlen(FORMAT_OPTION)) == 0 && strcmp(argv[i] + strlen(FORMAT_OPTION), "text") == 0)
+            options.object_format = TEXT_OBJECT_FORMAT;
+        else
+            print_error(ERROR_47, INTERNAL_ERROR_STAGE);
+    }
+    if (options.stream && (options.listing || options.object_format == BINARY_OBJECT_FORMAT))
+    {/* The listing and the binary object file need all the code words in memory */
+        print_error(ERROR_50, INTERNAL_ERROR_STAGE);
+        return 1;
+    }
 
     for (i = 1; i < argc; i++)
     {
+        if (strncmp(argv[i], "--", 2) == 0)
+            /* Option (already handled) */
+            continue;
+
         /* Reset the error number */
         current_error_number = ERROR_0;
 
@@ -24,7 +57,7 @@ int main(int argc, char *argv[])
         }
 
         /* Perform the first pass stage (and second pass stage which is inside 'first_pass_stage') */
-        if (first_pass_stage(argv[i]) != ERROR_0)
+        if (first_pass_stage(argv[i], &options) != ERROR_0)
         {
             /* If it failed, skip the 'Program succeeded' message and move to the next file */
             continue;
@@ -5,6 +5,48 @@
 
 /* This class contains auxiliary functions that are used in the assembler program. */
 
+/* Short names for the character classes (used only to keep the table below readable) */
+#define WS WHITESPACE_CHAR_CLASS
+#define CM COMMA_CHAR_CLASS
+#define CL COLON_CHAR_CLASS
+#define QT QUOTE_CHAR_CLASS
+#define HS HASH_CHAR_CLASS
+#define AM AMPERSAND_CHAR_CLASS
+#define SC SEMICOLON_CHAR_CLASS
+#define LB LABEL_CHAR_CLASS
+
+/** A table that maps every char value to the bitmask of the character classes it belongs to.
+ * It replaces the per-character chains of isspace/isalpha/isdigit/'==' checks with a single lookup,
+ * and a run of characters of the same class(es) can be skipped with one mask test per character.
+ * Values above ASCII_MAX belong to no class (same as the "C" locale). */
+const unsigned char CHAR_CLASSES[NUM_OF_CHARS] = {
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  WS, WS, WS, WS, WS, 0,  0,   /* 0x00 - 0x0F */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0x10 - 0x1F */
+    WS, 0,  QT, HS, 0,  0,  AM, 0,  0,  0,  0,  0,  CM, 0,  0,  0,   /* 0x20 - 0x2F:  !"#$%&'()*+,-./ */
+    LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, CL, SC, 0,  0,  0,  0,   /* 0x30 - 0x3F: 0123456789:;<=>? */
+    0,  LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB,  /* 0x40 - 0x4F: @A-O */
+    LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, 0,  0,  0,  0,  0,   /* 0x50 - 0x5F: P-Z[\]^_ */
+    0,  LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB,  /* 0x60 - 0x6F: `a-o */
+    LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, LB, 0,  0,  0,  0,  0,   /* 0x70 - 0x7F: p-z{|}~ */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0x80 - 0x8F */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0x90 - 0x9F */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xA0 - 0xAF */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xB0 - 0xBF */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xC0 - 0xCF */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xD0 - 0xDF */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xE0 - 0xEF */
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,   /* 0xF0 - 0xFF */
+};
+
+#undef WS
+#undef CM
+#undef CL
+#undef QT
+#undef HS
+#undef AM
+#undef SC
+#undef LB
+
 
 char* get_file_name(int num_of_args, char *first_arg, ...)
 {
@@ -59,12 +101,8 @@ void trim_leading_whitespaces(char *original_file_name, char *trimmed_file_name)
 
     while (fgets(line, sizeof(line), original_file))
     {/* Read each line from the original file */
-        ptr = line;
         /* Skip leading whitespaces */
-        while (isspace(*ptr))
-        {
-            ptr++;
-        }
+        ptr = skip_chars_of_class(line, WHITESPACE_CHAR_CLASS);
         /* Copy the trimmed line to trimmed_file */
         fputs(ptr, trimmed_file);
     }
@@ -77,9 +115,9 @@ void trim_leading_whitespaces(char *original_file_name, char *trimmed_file_name)
 int skip_whitespaces_and_commas(char **ptr)
 {
     int commas_count = 0;
-    while (isspace(**ptr) || **ptr == ',')
+    while (IS_OF_CHAR_CLASS(**ptr, WHITESPACE_CHAR_CLASS | COMMA_CHAR_CLASS))
     {
-        if (**ptr == ',')
+        if (IS_OF_CHAR_CLASS(**ptr, COMMA_CHAR_CLASS))
             /* Increase commas count */
             commas_count++;
         /* Skip character */
@@ -88,27 +126,63 @@ int skip_whitespaces_and_commas(char **ptr)
     return commas_count;
 }
 
-int is_valid_number(char *ptr)
+char *skip_chars_of_class(char *ptr, int char_class)
 {
-    /* Skip '-' or '+' sign if exists */
-    if (*ptr == '-' || *ptr == '+')
+    /* '\0' belongs to no class, so the loop always stops at the end of the string */
+    while (IS_OF_CHAR_CLASS(*ptr, char_class))
         ptr++;
+    return ptr;
+}
+
+char *find_char_of_class(char *ptr, int char_class)
+{
+    while (*ptr != '\0' && !IS_OF_CHAR_CLASS(*ptr, char_class))
+        ptr++;
+    return ptr;
+}
 
-    if (*ptr == '0')
+int parse_number(char *ptr, int length, int num_of_bits, int *number)
+{
+    char *end = ptr + length;
+    long value = 0;
+    long max_value = (1L << (num_of_bits - 1)) - 1;    /* The biggest number that fits in the field (in two's complement) */
+    long min_value = -(1L << (num_of_bits - 1));       /* The smallest number that fits in the field (in two's complement) */
+    int is_negative = 0;
+
+    /* Skip '-' or '+' sign if exists */
+    if (ptr < end && (*ptr == '-' || *ptr == '+'))
+        is_negative = (*ptr++ == '-');
+
+    if (ptr < end && *ptr == '0')
     {/* Number cannot start with 0 */
         print_error(ERROR_22, AM_FILE_STAGE);
         return 0;
     }
 
-    while (*ptr != '\0')
+    /* Validate and accumulate the digits in the same pass */
+    for (; ptr < end; ptr++)
     {
-        if (!isdigit(*ptr++))
+        if (!isdigit(*ptr))
         {/* A valid number consists of digits only */
             print_error(ERROR_23, AM_FILE_STAGE);
             return 0;
         }
+        if (value <= max_value)
+            /* Stop accumulating once the number is out of range (in order to prevent an overflow) */
+            value = value * DECIMAL_BASE + (*ptr - '0');
     }
+
+    if (is_negative)
+        value = -value;
+
+    if (value > max_value || value < min_value)
+    {/* Number does not fit in the field */
+        print_error(ERROR_41, AM_FILE_STAGE);
+        return 0;
+    }
+
     /* Number is valid */
+    *number = (int)value;
     return 1;
 }
 
@@ -118,13 +192,8 @@ int is_valid_label_syntax(char *operand)
         /* Label must start with an alphabetic character */
         return 0;
 
-    /* Start checking from next char */
-    operand++;
-
-    while (isalpha(*operand) || isdigit(*operand))
-    {/* Label contains only alphabetic characters and digits */
-        operand++;
-    }
+    /* Start checking from next char, and skip all alphabetic characters and digits */
+    operand = skip_chars_of_class(operand + 1, LABEL_CHAR_CLASS);
 
     if (*operand != '\0')
         /* Label contains char that is not: alphabetic nor digit */
@@ -134,16 +203,48 @@ int is_valid_label_syntax(char *operand)
     return 1;
 }
 
-void reverse_string(char *string)
+unsigned int hash_string(char *string)
+{
+    /* djb2 hash: hash * 33 + c (in 32 bits) */
+    unsigned int hash = 5381;
+    while (*string != '\0')
+        hash = hash * 33 + (unsigned char)*string++;
+    return hash;
+}
+
+void print_peak_memory_usage(void)
 {
-    int i, j;
-    char temp;
-    for (i = 0, j = WORD_SIZE - 1; i < j; i++, j--)
-    {/* Swap characters */
-        temp = string[i];
-        string[i] = string[j];
-        string[j] = temp;
+    char line[MAX_LINE_LENGTH];
+    FILE *status_file = fopen("/proc/self/status", "r");
+
+    if (status_file != NULL)
+    {
+        while (fgets(line, sizeof(line), status_file))
+        {/* The line is "VmHWM:" and the size (in kB) */
+            if (strncmp(line, "VmHWM:", strlen("VmHWM:")) == 0)
+            {
+                printf("Peak memory usage: %s", skip_chars_of_class(line + strlen("VmHWM:"), WHITESPACE_CHAR_CLASS));
+                fclose(status_file);
+                return;
+            }
+        }
+        fclose(status_file);
     }
+    printf("Peak memory usage: not available\n");
+}
+
+int estimate_num_of_lines(FILE *file)
+{
+    long file_size;
+
+    /* Find the size of the file, and go back to its beginning */
+    fseek(file, 0, SEEK_END);
+    file_size = ftell(file);
+    rewind(file);
+
+    if (file_size <= 0)
+        return 0;
+    return (int)(file_size / ESTIMATED_LINE_LENGTH) + 1;
 }
 
 int is_ascii(int c)
@@ -151,22 +252,21 @@ int is_ascii(int c)
     return c >= ASCII_MIN && c <= ASCII_MAX;
 }
 
-void initialize_array_with_zeros(char *array, int array_length)
+int is_ascii_span(char *span, int length)
 {
+    unsigned char all_bits = 0;
     int i;
-    for (i = 0; i < array_length; i++)
-    {
-        array[i] = '0';
-    }
-    /* Add null terminator */
-    array[array_length] = '\0';
+
+    /* ASCII chars are 0..127, so they never have the high bit => OR all the chars and test the result once (the loop has no branches) */
+    for (i = 0; i < length; i++)
+        all_bits |= (unsigned char)span[i];
+    return all_bits <= ASCII_MAX;
 }
 
 void check_no_extra_chars(char **ptr)
 {
     /* Skip whitespaces */
-    while (isspace(**ptr))
-        (*ptr)++;
+    *ptr = skip_chars_of_class(*ptr, WHITESPACE_CHAR_CLASS);
 
     if (**ptr != '\n' && **ptr != '\0')
     {/* End of line has not been reached */
@@ -4,6 +4,12 @@
 
 #include <stdarg.h>
 
+/** A table that maps every char value to the bitmask of the character classes it belongs to (defined in auxiliary_functions.c) */
+extern const unsigned char CHAR_CLASSES[];
+
+/** Checks if the character 'c' belongs to at least one of the classes in 'char_class' (a bitwise OR of *_CHAR_CLASS values) */
+#define IS_OF_CHAR_CLASS(c, char_class) (CHAR_CLASSES[(unsigned char)(c)] & (char_class))
+
 /**
  * Creates a file name with a specific extension based on input arguments.
  * This function uses variable argument lists (va_list) to concatenate multiple string components
@@ -46,16 +52,47 @@ void trim_leading_whitespaces(char *original_file_name, char *updated_file_name)
 int skip_whitespaces_and_commas(char **ptr);
 
 /**
- * Checks if a string is a valid number representation (according to the definition in the course booklet).
+ * Skips all characters that belong to at least one of the given character classes.
+ *
+ * Input:
+ *   - ptr: Pointer to the current position in a string
+ *   - char_class: Bitwise OR of the *_CHAR_CLASS values to skip
+ *
+ * Output:
+ *   - Returns a pointer to the first character that belongs to none of the given classes
+ */
+char *skip_chars_of_class(char *ptr, int char_class);
+
+
+/**
+ * Finds the first character that belongs to at least one of the given character classes (or the end of the string).
+ *
+ * Input:
+ *   - ptr: Pointer to the current position in a string
+ *   - char_class: Bitwise OR of the *_CHAR_CLASS values to stop at
+ *
+ * Output:
+ *   - Returns a pointer to the first character of the given classes, or to the '\0' at the end of the string
+ */
+char *find_char_of_class(char *ptr, int char_class);
+
+/**
+ * Parses a number (according to the definition in the course booklet) and checks that it fits in a field of a word.
  * Valid numbers must not start with leading zeros, must only contain digit characters (after an optional sign).
+ * The number is validated, range checked and converted in a single pass over its characters.
+ * A number fits in a field of 'num_of_bits' bits if it is between -2^(num_of_bits-1) and 2^(num_of_bits-1) - 1 (two's complement),
+ * so a number is never read as a different number (e.g. 2^num_of_bits - 1 as -1).
  *
  * Input:
- *   - ptr: String to validate as a number
+ *   - ptr: Pointer to the first character of the number (the number does not have to be null terminated)
+ *   - length: Number of characters in the number (including the sign)
+ *   - num_of_bits: Number of bits of the field the number is stored in
+ *   - number: Pointer to where the value of the number is stored (only if it is valid)
  *
  * Output:
- *   - Returns 1 if the string is a valid number, 0 otherwise
+ *   - Returns 1 if the number is valid, 0 otherwise (an error is printed)
  */
-int is_valid_number(char *ptr);
+int parse_number(char *ptr, int length, int num_of_bits, int *number);
 
 /**
  * Validates if a string has correct label syntax (according to the definition in the course booklet).
@@ -72,15 +109,38 @@ int is_valid_number(char *ptr);
 int is_valid_label_syntax(char *operand);
 
 /**
- * Reverses a string in place swapping characters from opposite ends..
+ * Computes the hash of a string (djb2).
+ *
+ * Input:
+ *   - string: The string (null terminated)
+ *
+ * Output:
+ *   - Returns the hash of the string
+ */
+unsigned int hash_string(char *string);
+
+/**
+ * Prints the peak resident memory of the process (VmHWM in /proc/self/status), or that it is not available on this system.
  *
  * Input:
- *   - string: String to be reversed
+ *   - None
  *
  * Output:
  *   - No return value
  */
-void reverse_string(char *string);
+void print_peak_memory_usage(void);
+
+/**
+ * Estimates the number of lines in a file from its size (without reading it).
+ * The file position is moved to the beginning of the file.
+ *
+ * Input:
+ *   - file: The file (opened for reading)
+ *
+ * Output:
+ *   - Returns the estimated number of lines
+ */
+int estimate_num_of_lines(FILE *file);
 
 /**
  * Checks if a character is within ASCII range (between ASCII_MIN and ASCII_MAX constants).
@@ -94,16 +154,16 @@ void reverse_string(char *string);
 int is_ascii(int c);
 
 /**
- * Initializes a character array with '0' characters.
+ * Checks if all the characters of a span are within ASCII range (between ASCII_MIN and ASCII_MAX constants).
  *
  * Input:
- *   - array: Character array to initialize
- *   - array_length: Length of the array to initialize
+ *   - span: Pointer to the first character
+ *   - length: Number of characters to check
  *
  * Output:
- *   - No return value
+ *   - Returns 1 if all the characters are in ASCII range, 0 otherwise
  */
-void initialize_array_with_zeros(char *array, int array_length);
+int is_ascii_span(char *span, int length);
 
 /**
  * Checks if there are any non-whitespace characters after the current position in the string.
@@ -0,0 +1,79 @@
+#include "general_header.h"
+#include "bench.h"
+#include "convertor.h"
+#include "parser.h"
+#include "errors.h"
+#include <time.h>
+
+
+/* This is the main function of the bench program (see bench.h). */
+int main(void)
+{
+    int i;
+    unsigned long seed = BENCH_RANDOM_SEED;
+    unsigned long fields_checksum, templates_checksum;
+    encoded_instruction *instructions = safe_malloc(BENCH_NUM_OF_INSTRUCTIONS * sizeof(encoded_instruction));
+
+    for (i = 0; i < BENCH_NUM_OF_INSTRUCTIONS; i++)
+        generate_instruction(&instructions[i], &seed);
+
+    fields_checksum = time_first_word_encoder("field by field", instructions, 0);
+    templates_checksum = time_first_word_encoder("templates", instructions, 1);
+    free(instructions);
+
+    if (fields_checksum != templates_checksum)
+    {
+        printf("The encoders gave different words\n");
+        return 1;
+    }
+    return 0;
+}
+
+void generate_instruction(encoded_instruction *instruction, unsigned long *seed)
+{
+    instruction_info *info;
+
+    /* A linear congruential generator (the high bits are used - they are the most random) */
+    *seed = (*seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    info = &INSTRUCTIONS[(*seed >> 16) % NUM_OF_INSTRUCTIONS];
+
+    instruction->opcode = info->opcode;
+    instruction->funct = info->funct;
+    instruction->first_word_template = info->first_word_template;
+    instruction->source_addressing_mode = (int)((*seed >> 8) % NUM_OF_ADDRESSING_MODES);
+    instruction->source_register = (int)((*seed >> 10) % NUM_OF_REGISTERS);
+    instruction->destination_addressing_mode = (int)((*seed >> 13) % NUM_OF_ADDRESSING_MODES);
+    instruction->destination_register = (int)((*seed >> 24) % NUM_OF_REGISTERS);
+    instruction->A = 1;
+    instruction->R = 0;
+    instruction->E = 0;
+}
+
+int encode_first_word_by_fields(encoded_instruction *instruction)
+{
+    return ENCODE_FIELD(OPCODE, instruction->opcode) | ENCODE_FIELD(FUNCT, instruction->funct)
+         | ENCODE_FIELD(SOURCE_ADDRESSING_MODE, instruction->source_addressing_mode) | ENCODE_FIELD(SOURCE_REGISTER, instruction->source_register)
+         | ENCODE_FIELD(DESTINATION_ADDRESSING_MODE, instruction->destination_addressing_mode) | ENCODE_FIELD(DESTINATION_REGISTER, instruction->destination_register)
+         | ENCODE_FIELD(A, instruction->A) | ENCODE_FIELD(R, instruction->R) | ENCODE_FIELD(E, instruction->E);
+}
+
+unsigned long time_first_word_encoder(char *name, encoded_instruction *instructions, int use_templates)
+{
+    int i, round;
+    unsigned long checksum = 0;
+    encoded_instruction *instruction;
+    clock_t start = clock();
+
+    for (round = 0; round < BENCH_NUM_OF_ROUNDS; round++)
+    {
+        for (i = 0; i < BENCH_NUM_OF_INSTRUCTIONS; i++)
+        {/* The checksum depends on every word (so the encoding is not optimized away) */
+            instruction = &instructions[i];
+            checksum = checksum * 31 + (unsigned long)(use_templates ? first_word_to_binary(&instruction) : encode_first_word_by_fields(instruction));
+        }
+    }
+
+    printf("%-16s %.2f ns per instruction (checksum %lx)\n", name,
+           (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / ((double)BENCH_NUM_OF_ROUNDS * BENCH_NUM_OF_INSTRUCTIONS), checksum & 0xFFFFFFFFUL);
+    return checksum;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+
+#include "first_pass.h"
+
+/* The bench program (make bench) measures the cost of encoding the first word of an instruction on BENCH_NUM_OF_INSTRUCTIONS
+ * generated instructions: first_word_to_binary (the template of the instruction ORed with the pre-shifted operand fields)
+ * against encode_first_word_by_fields (every field is shifted into the word separately).
+ * Both encoders must give the same words (their checksums are compared).
+ */
+
+#define BENCH_NUM_OF_INSTRUCTIONS 1000000    /** Number of generated instructions (the size of a large program) */
+#define BENCH_NUM_OF_ROUNDS 100              /** Number of times every instruction is encoded by each encoder */
+#define BENCH_RANDOM_SEED 12345UL            /** Seed of the generator of the instructions (the input is the same in every run) */
+
+
+/**
+ * Fills an instruction with random fields (a random instruction of INSTRUCTIONS, random addressing modes and registers).
+ *
+ * Input:
+ *   - instruction: Pointer to the instruction
+ *   - seed: Pointer to the state of the random generator
+ *
+ * Output:
+ *   - No return value
+ */
+void generate_instruction(encoded_instruction *instruction, unsigned long *seed);
+
+
+/**
+ * Encodes the first word of an instruction field by field (the encoding that the templates replace).
+ *
+ * Input:
+ *   - instruction: Pointer to the instruction
+ *
+ * Output:
+ *   - Returns the encoded word
+ */
+int encode_first_word_by_fields(encoded_instruction *instruction);
+
+
+/**
+ * Encodes the first words of all the instructions BENCH_NUM_OF_ROUNDS times, and prints the time per instruction.
+ *
+ * Input:
+ *   - name: The name of the encoder (for the report)
+ *   - instructions: The instructions
+ *   - use_templates: 1 for first_word_to_binary, 0 for encode_first_word_by_fields
+ *
+ * Output:
+ *   - Returns the checksum of the encoded words
+ */
+unsigned long time_first_word_encoder(char *name, encoded_instruction *instructions, int use_templates);
+
+
+#endif /* BENCH_H */
\ No newline at end of file
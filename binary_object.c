@@ -0,0 +1,186 @@
+#include "binary_object.h"
+#include "general_header.h"
+#include "auxiliary_functions.h"
+#include "errors.h"
+
+
+/* This class contains the functions of the binary object file (--format=bin): its writer, and a loader for tools that read it.
+ * The format is described in binary_object.h.
+ */
+
+
+void create_binary_object_file(FILE *file, word_store *code, word_store *data, int ICF, int DCF, general_table *entries, int entries_lines, general_table *externs, int externs_lines)
+{
+    int i, j;
+    int repeat_count, run = 0;  /* The number of words of the current data line */
+    long size;                  /* Size of the file */
+    unsigned char *bytes, *ptr;
+
+    if (ICF-INITIAL_IC_VALUE + DCF > MAX_NUM_OF_WORDS)
+    {/* Check if the number of words in the object file exceeds the maximum number of words */
+        print_error(ERROR_3, AM_FILE_STAGE);
+        return;
+    }
+
+    size = BINARY_OBJECT_HEADER_SIZE + (long)(ICF-INITIAL_IC_VALUE + DCF) * BYTES_PER_WORD + (long)(entries_lines + externs_lines) * BINARY_SYMBOL_RECORD_SIZE;
+    bytes = safe_malloc(size);
+    if (bytes == NULL)
+        return;
+    memset(bytes, 0, size);  /* The label names are padded with '\0' */
+
+    /* The words (a .space/.fill run is expanded to a word per address) */
+    ptr = bytes + BINARY_OBJECT_HEADER_SIZE;
+    for (i = 0; i < code->lines; i++, ptr += BYTES_PER_WORD)
+        put_binary_number(ptr, (unsigned long)code->words[i], BYTES_PER_WORD);
+    for (i = 0; i < data->lines; i++)
+    {
+        repeat_count = (run < data->runs_lines && data->runs[run].index == i) ? data->runs[run++].repeat_count : 1;
+        for (j = 0; j < repeat_count; j++, ptr += BYTES_PER_WORD)
+            put_binary_number(ptr, (unsigned long)data->words[i], BYTES_PER_WORD);
+    }
+
+    /* The entries and externals */
+    ptr = put_binary_symbol_records(ptr, entries, entries_lines);
+    put_binary_symbol_records(ptr, externs, externs_lines);
+
+    /* The header (the checksum is of everything after the header) */
+    memcpy(bytes, BINARY_OBJECT_MAGIC, BINARY_OBJECT_MAGIC_LENGTH);
+    ptr = bytes + BINARY_OBJECT_MAGIC_LENGTH;
+    put_binary_number(ptr, ICF-INITIAL_IC_VALUE, BINARY_NUMBER_SIZE);
+    put_binary_number(ptr + BINARY_NUMBER_SIZE, DCF, BINARY_NUMBER_SIZE);
+    put_binary_number(ptr + 2 * BINARY_NUMBER_SIZE, entries_lines, BINARY_NUMBER_SIZE);
+    put_binary_number(ptr + 3 * BINARY_NUMBER_SIZE, externs_lines, BINARY_NUMBER_SIZE);
+    put_binary_number(ptr + 4 * BINARY_NUMBER_SIZE, binary_object_checksum(bytes + BINARY_OBJECT_HEADER_SIZE, size - BINARY_OBJECT_HEADER_SIZE), BINARY_NUMBER_SIZE);
+
+    fwrite(bytes, 1, size, file);
+    free(bytes);
+}
+
+unsigned char *put_binary_symbol_records(unsigned char *bytes, general_table *table, int lines)
+{
+    int i;
+    for (i = 0; i < lines; i++, bytes += BINARY_SYMBOL_RECORD_SIZE)
+    {/* The name (at most MAX_LABEL_LENGTH characters => it is always followed by '\0') and the address */
+        strncpy((char *)bytes, table[i].label, MAX_LABEL_LENGTH);
+        put_binary_number(bytes + BINARY_LABEL_SIZE, table[i].address, BINARY_NUMBER_SIZE);
+    }
+    return bytes;
+}
+
+int load_binary_object(char *file_name, binary_object *object)
+{
+    FILE *file;
+    unsigned char *header;
+    unsigned char *record;  /* The current entry/external record */
+    unsigned long code_words, data_words, entries, externs;  /* The counts of the header (validated before they are narrowed to int) */
+
+    object->bytes = NULL;
+    file = fopen(file_name, "rb");
+    if (file == NULL)
+        return ERROR_2;
+
+    /* Read the whole file to a single block */
+    fseek(file, 0L, SEEK_END);
+    object->size = ftell(file);
+    rewind(file);
+    if (object->size < BINARY_OBJECT_HEADER_SIZE)
+    {/* Too short for a header */
+        fclose(file);
+        return ERROR_48;
+    }
+    object->bytes = safe_malloc(object->size);
+    if (object->bytes == NULL)
+    {/* Memory allocation failed */
+        fclose(file);
+        return ERROR_1;
+    }
+    if (fread(object->bytes, 1, object->size, file) != (size_t)object->size)
+    {/* The file could not be read */
+        fclose(file);
+        free_binary_object(object);
+        return ERROR_48;
+    }
+    fclose(file);
+
+    /* The header */
+    header = object->bytes + BINARY_OBJECT_MAGIC_LENGTH;
+    code_words = get_binary_number(header, BINARY_NUMBER_SIZE);
+    data_words = get_binary_number(header + BINARY_NUMBER_SIZE, BINARY_NUMBER_SIZE);
+    entries = get_binary_number(header + 2 * BINARY_NUMBER_SIZE, BINARY_NUMBER_SIZE);
+    externs = get_binary_number(header + 3 * BINARY_NUMBER_SIZE, BINARY_NUMBER_SIZE);
+
+    /* Each count is checked on its own before the counts are added (the sums cannot overflow) */
+    if (memcmp(object->bytes, BINARY_OBJECT_MAGIC, BINARY_OBJECT_MAGIC_LENGTH) != 0
+        || code_words > MAX_NUM_OF_WORDS || data_words > MAX_NUM_OF_WORDS - code_words
+        || entries > MAX_NUM_OF_WORDS || externs > MAX_NUM_OF_WORDS - entries
+        || (unsigned long)object->size != BINARY_OBJECT_HEADER_SIZE + (code_words + data_words) * BYTES_PER_WORD
+                                          + (entries + externs) * BINARY_SYMBOL_RECORD_SIZE
+        || get_binary_number(header + 4 * BINARY_NUMBER_SIZE, BINARY_NUMBER_SIZE) != binary_object_checksum(object->bytes + BINARY_OBJECT_HEADER_SIZE, object->size - BINARY_OBJECT_HEADER_SIZE))
+    {/* Not a binary object file, or the file is damaged */
+        free_binary_object(object);
+        return ERROR_48;
+    }
+    /* The counts are valid => they fit in an int */
+    object->code_words = (int)code_words;
+    object->data_words = (int)data_words;
+    object->entries = (int)entries;
+    object->externs = (int)externs;
+
+    /* The sections (they follow each other) */
+    object->words = object->bytes + BINARY_OBJECT_HEADER_SIZE;
+    object->entry_records = object->words + (long)(object->code_words + object->data_words) * BYTES_PER_WORD;
+    object->extern_records = object->entry_records + (long)object->entries * BINARY_SYMBOL_RECORD_SIZE;
+
+    for (record = object->entry_records; record < object->bytes + object->size; record += BINARY_SYMBOL_RECORD_SIZE)
+    {/* The name of every entry/external record must end inside its field (the names are used as strings) */
+        if (memchr(record, '\0', BINARY_LABEL_SIZE) == NULL)
+        {
+            free_binary_object(object);
+            return ERROR_48;
+        }
+    }
+    return ERROR_0;
+}
+
+void free_binary_object(binary_object *object)
+{
+    free(object->bytes);
+    object->bytes = NULL;
+}
+
+int get_binary_object_word(binary_object *object, int index)
+{
+    return (int)get_binary_number(object->words + (long)index * BYTES_PER_WORD, BYTES_PER_WORD);
+}
+
+int get_binary_symbol_address(unsigned char *record)
+{
+    return (int)get_binary_number(record + BINARY_LABEL_SIZE, BINARY_NUMBER_SIZE);
+}
+
+void put_binary_number(unsigned char *bytes, unsigned long number, int size)
+{
+    int i;
+    for (i = size - 1; i >= 0; i--, number >>= BITS_PER_BYTE)
+        /* From the least significant byte (the last one) */
+        bytes[i] = (unsigned char)(number & BITS_MASK(BITS_PER_BYTE));
+}
+
+unsigned long get_binary_number(unsigned char *bytes, int size)
+{
+    int i;
+    unsigned long number = 0;
+    for (i = 0; i < size; i++)
+        /* From the most significant byte (the first one) */
+        number = (number << BITS_PER_BYTE) | bytes[i];
+    return number;
+}
+
+unsigned long binary_object_checksum(unsigned char *bytes, long length)
+{
+    long i;
+    unsigned long checksum = 5381;
+    for (i = 0; i < length; i++)
+        checksum = ((checksum << 5) + checksum + bytes[i]) & 0xFFFFFFFFUL;
+    return checksum;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef BINARY_OBJECT_H
+#define BINARY_OBJECT_H
+
+
+#include "first_pass.h"
+
+/* The binary object file (--format=bin) - an alternative to the text object file (".ob") that needs no parsing.
+ * All the numbers are unsigned and big endian. The file is made of:
+ * 1. The header: the magic "AOB1", and 5 numbers of 4 bytes - the number of code words, the number of data words,
+ *    the number of entries, the number of externals, and the checksum of the rest of the file (see binary_object_checksum).
+ * 2. The words (3 bytes each): the code words (from address INITIAL_IC_VALUE) and then the data words (from address ICF).
+ * 3. The entries and then the externals: a record of BINARY_SYMBOL_RECORD_SIZE bytes each -
+ *    the label name (padded with '\0' to BINARY_LABEL_SIZE bytes) and its address (4 bytes).
+ */
+
+#define BINARY_OBJECT_MAGIC "AOB1"                  /** The first bytes of a binary object file */
+#define BINARY_OBJECT_MAGIC_LENGTH 4                /** Length of the magic (without '\0') */
+#define BINARY_NUMBER_SIZE 4                        /** Number of bytes of a number in the header or in a record */
+#define BINARY_OBJECT_HEADER_SIZE (BINARY_OBJECT_MAGIC_LENGTH + 5 * BINARY_NUMBER_SIZE)  /** The magic and 5 numbers */
+#define BINARY_LABEL_SIZE (MAX_LABEL_LENGTH + 1)    /** A label name and at least one '\0' */
+#define BINARY_SYMBOL_RECORD_SIZE (BINARY_LABEL_SIZE + BINARY_NUMBER_SIZE)  /** An entry/external record: name and address */
+#define BINARY_OBJECT_EXTENSION ".obj"              /** Extension of the binary object file */
+
+/** A binary object file that was loaded to memory.
+ * The file is read to a single block, and all the pointers point into it (nothing is copied or parsed) */
+typedef struct binary_object {
+    unsigned char *bytes;           /* The whole file */
+    long size;                      /* Size of the file in bytes */
+    int code_words;                 /* Number of code words (ICF - INITIAL_IC_VALUE) */
+    int data_words;                 /* Number of data words (DCF) */
+    int entries;                    /* Number of entry records */
+    int externs;                    /* Number of external records */
+    unsigned char *words;           /* The code words and then the data words (BYTES_PER_WORD bytes each) */
+    unsigned char *entry_records;   /* The entry records (BINARY_SYMBOL_RECORD_SIZE bytes each) */
+    unsigned char *extern_records;  /* The external records (BINARY_SYMBOL_RECORD_SIZE bytes each) */
+} binary_object;
+
+
+/**
+ * Creates the binary object file: the whole file is built in one buffer (its size is known from the tables) and written with a single fwrite.
+ *
+ * Input:
+ *   - file: Pointer to the file (opened in binary mode)
+ *   - code: Pointer to the code table
+ *   - data: Pointer to the data table
+ *   - ICF: Final instruction counter value from first pass
+ *   - DCF: Final data counter value from first pass
+ *   - entries: The entries table
+ *   - entries_lines: Number of lines in the entries table
+ *   - externs: The externs table
+ *   - externs_lines: Number of lines in the externs table
+ *
+ * Output:
+ *   - No return value
+ */
+void create_binary_object_file(FILE *file, word_store *code, word_store *data, int ICF, int DCF, general_table *entries, int entries_lines, general_table *externs, int externs_lines);
+
+
+/**
+ * Writes the records of an entries/externs table into a buffer.
+ *
+ * Input:
+ *   - bytes: The buffer (of at least lines * BINARY_SYMBOL_RECORD_SIZE bytes)
+ *   - table: The entries/externs table
+ *   - lines: Number of lines in the table
+ *
+ * Output:
+ *   - Returns a pointer to the byte after the last record
+ */
+unsigned char *put_binary_symbol_records(unsigned char *bytes, general_table *table, int lines);
+
+
+/**
+ * Loads a binary object file to memory, and checks its header, its size, its checksum and the names of its entry/external records
+ * (each one must end with a '\0' inside its BINARY_LABEL_SIZE bytes).
+ *
+ * Input:
+ *   - file_name: The name of the file
+ *   - object: Pointer to the structure that is filled (its 'bytes' are freed with free_binary_object)
+ *
+ * Output:
+ *   - Returns ERROR_0 if the file was loaded
+ *   - Returns ERROR_2 if the file cannot be opened, or ERROR_48 if it is not a valid binary object file
+ */
+int load_binary_object(char *file_name, binary_object *object);
+
+
+/**
+ * Frees the memory of a loaded binary object file.
+ *
+ * Input:
+ *   - object: Pointer to the loaded binary object
+ *
+ * Output:
+ *   - No return value
+ */
+void free_binary_object(binary_object *object);
+
+
+/**
+ * Gets a word of a loaded binary object file.
+ *
+ * Input:
+ *   - object: Pointer to the loaded binary object
+ *   - index: Index of the word (the code words are first, and then the data words)
+ *
+ * Output:
+ *   - Returns the machine code of the word
+ */
+int get_binary_object_word(binary_object *object, int index);
+
+
+/**
+ * Gets the address of an entry/external record.
+ *
+ * Input:
+ *   - record: Pointer to the record (the record itself starts with the label name, as a null terminated string)
+ *
+ * Output:
+ *   - Returns the address of the record
+ */
+int get_binary_symbol_address(unsigned char *record);
+
+
+/**
+ * Writes an unsigned number in big endian order.
+ *
+ * Input:
+ *   - bytes: The buffer
+ *   - number: The number
+ *   - size: Number of bytes to write
+ *
+ * Output:
+ *   - No return value
+ */
+void put_binary_number(unsigned char *bytes, unsigned long number, int size);
+
+
+/**
+ * Reads an unsigned number in big endian order.
+ *
+ * Input:
+ *   - bytes: The buffer
+ *   - size: Number of bytes to read
+ *
+ * Output:
+ *   - Returns the number
+ */
+unsigned long get_binary_number(unsigned char *bytes, int size);
+
+
+/**
+ * Calculates the checksum of a block of bytes (the djb2 hash, cut to 32 bits).
+ *
+ * Input:
+ *   - bytes: The block
+ *   - length: Number of bytes in the block
+ *
+ * Output:
+ *   - Returns the checksum
+ */
+unsigned long binary_object_checksum(unsigned char *bytes, long length);
+
+
+#endif /* BINARY_OBJECT_H */
\ No newline at end of file
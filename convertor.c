@@ -10,39 +10,29 @@
 /* This class contains functions that convert the data from the first pass to binary format.
  * The functions are used to convert the instructions and directives to binary format.
  * The functions are also used to add the binary data to the code and data tables.
+ * Each word is built directly as an integer (with the shifts and masks of isa_spec.h).
  */
 
 
-void add_zeros(char *word_in_binary, int *binary_index, int required_zeros)
-{
-    int i;
-    for (i = 0; i < required_zeros; i++)
-    {
-        word_in_binary[(*binary_index)++] = '0';
-    }
-    /* Null termination */
-    word_in_binary[*binary_index] = '\0';
-}
+/* Values 0..3 and 0..7 of a field of the first word (used to build the tables below) */
+#define FIELD_VALUES_0_TO_3(field) ENCODE_FIELD(field, 0), ENCODE_FIELD(field, 1), ENCODE_FIELD(field, 2), ENCODE_FIELD(field, 3)
+#define FIELD_VALUES_0_TO_7(field) FIELD_VALUES_0_TO_3(field), ENCODE_FIELD(field, 4), ENCODE_FIELD(field, 5), ENCODE_FIELD(field, 6), ENCODE_FIELD(field, 7)
 
-void integer_to_binary(int num, char *word_in_binary, int *binary_index)
-{
-    /* Save the binary representation of 'num' in the array: word_in_binary */
-    word_in_binary[(*binary_index)++] = (num % BINARY_BASE) ? '1' : '0';
-    if (num > 1)
-    {/* If num is greater than 1, continue dividing by 2 */
-        integer_to_binary(num / BINARY_BASE, word_in_binary, binary_index);
-    }
-}
+/** Tables of the operand fields of the first word, already shifted to their position (computed at compile time).
+ * They are indexed by the addressing mode / register number of the operand. */
+int SOURCE_ADDRESSING_MODE_FIELDS[NUM_OF_ADDRESSING_MODES] = {FIELD_VALUES_0_TO_3(SOURCE_ADDRESSING_MODE)};
+int SOURCE_REGISTER_FIELDS[NUM_OF_REGISTERS] = {FIELD_VALUES_0_TO_7(SOURCE_REGISTER)};
+int DESTINATION_ADDRESSING_MODE_FIELDS[NUM_OF_ADDRESSING_MODES] = {FIELD_VALUES_0_TO_3(DESTINATION_ADDRESSING_MODE)};
+int DESTINATION_REGISTER_FIELDS[NUM_OF_REGISTERS] = {FIELD_VALUES_0_TO_7(DESTINATION_REGISTER)};
 
-void instruction_to_binary(encoded_instruction **instruction_line, code_data_array **code, int *IC)
-{
-    char word_in_binary[WORD_SIZE]; /* Array to store the binary representation of a word */
+#undef FIELD_VALUES_0_TO_3
+#undef FIELD_VALUES_0_TO_7
 
-    /* Get the binary representation of the first word */
-    first_word_to_binary(instruction_line, word_in_binary);
 
-    /* Add the first word to the code array */
-    add_to_code_table(code, IC, word_in_binary, NULL);
+void instruction_to_binary(encoded_instruction **instruction_line, word_store *code, int *IC)
+{
+    /* Encode the first word and add it to the code array */
+    add_to_code_table(code, IC, first_word_to_binary(instruction_line));
 
     /*
      * Continue and add the words representing the operands (if necessary)
@@ -50,176 +40,101 @@ void instruction_to_binary(encoded_instruction **instruction_line, code_data_arr
      */
     if ((*instruction_line)->num_of_args == 1)
     {
-        operand_word_to_binary(instruction_line, code, IC, word_in_binary, 1);
+        operand_word_to_binary(instruction_line, code, IC, 1);
     }
     else if ((*instruction_line)->num_of_args == 2)
     {
-        operand_word_to_binary(instruction_line, code, IC, word_in_binary, 0);
-        operand_word_to_binary(instruction_line, code, IC, word_in_binary, 1);
+        operand_word_to_binary(instruction_line, code, IC, 0);
+        operand_word_to_binary(instruction_line, code, IC, 1);
     }
 }
 
-void first_word_to_binary(encoded_instruction **instruction_line, char *word_in_binary)
+int first_word_to_binary(encoded_instruction **instruction_line)
 {
-    int binary_index = 0, finished_bits = 0;
-
     /*
-     * Convert each field of the encoded instruction to binary, and append it to the array: word_in_binary
-     * After converting each field, we add zeros to the array to fill out the rest of the field.
-     * At the end, we reverse the array to get the correct binary representation of the word.
-     *
-     * Notes:
-     * 1. We are starting with 'E' which is the first field of a "word", and ending with 'opcode' which is the last field of a "word"
-     * 2. The expression: [finished_bits + "field"_NUM_OF_BITS - binary_index] is true because:
-     *   - finished_bits: the number of bits that have been added to the array in the previous fields.
-     *   - "field"_NUM_OF_BITS: the number of bits that the current field should have.
-     *   - binary_index: the current index in the array.
+     * The opcode, funct and A,R,E fields are already in the template of the instruction (INSTRUCTIONS in parser.c),
+     * and the operand fields are taken pre-shifted from the tables above => the word is a few ORs
      */
-    integer_to_binary((*instruction_line)->E, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + E_NUM_OF_BITS - binary_index);
-    finished_bits += E_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->R, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + R_NUM_OF_BITS - binary_index);
-    finished_bits += R_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->A, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + A_NUM_OF_BITS - binary_index);
-    finished_bits += A_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->funct, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + FUNCT_NUM_OF_BITS - binary_index);
-    finished_bits += FUNCT_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->destination_register, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + DESTINATION_REGISTER_NUM_OF_BITS - binary_index);
-    finished_bits += DESTINATION_REGISTER_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->destination_addressing_mode, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + DESTINATION_ADDRESSING_MODE_NUM_OF_BITS - binary_index);
-    finished_bits += DESTINATION_ADDRESSING_MODE_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->source_register, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + SOURCE_REGISTER_NUM_OF_BITS - binary_index);
-    finished_bits += SOURCE_REGISTER_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->source_addressing_mode, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + SOURCE_ADDRESSING_MODE_NUM_OF_BITS - binary_index);
-    finished_bits += SOURCE_ADDRESSING_MODE_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->opcode, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + OPCODE_NUM_OF_BITS - binary_index);
-    finished_bits += OPCODE_NUM_OF_BITS;
-
-    /* Add null terminator */
-    word_in_binary[binary_index] = '\0';
-
-    /* Reverse the string to get the correct binary representation */
-    reverse_string(word_in_binary);
+    return (*instruction_line)->first_word_template
+         | SOURCE_ADDRESSING_MODE_FIELDS[(*instruction_line)->source_addressing_mode]
+         | SOURCE_REGISTER_FIELDS[(*instruction_line)->source_register]
+         | DESTINATION_ADDRESSING_MODE_FIELDS[(*instruction_line)->destination_addressing_mode]
+         | DESTINATION_REGISTER_FIELDS[(*instruction_line)->destination_register];
 }
 
-void operand_word_to_binary(encoded_instruction **instruction_line, code_data_array **code, int *IC, char *word_in_binary, int is_destination_operand)
+void operand_word_to_binary(encoded_instruction **instruction_line, word_store *code, int *IC, int is_destination_operand)
 {
     int addressing_mode;
+    char *operand;
 
     /* Get the addressing mode of the operand */
     if (is_destination_operand)
+    {
         addressing_mode = (*instruction_line)->destination_addressing_mode;
+        operand = (*instruction_line)->destination_operand;
+    }
     else
-        /* Source operand */
+    {/* Source operand */
         addressing_mode = (*instruction_line)->source_addressing_mode;
+        operand = (*instruction_line)->source_operand;
+    }
 
     if (addressing_mode == IMMEDIATE_ADDRESSING_MODE || addressing_mode == DIRECT_ADDRESSING_MODE || addressing_mode == RELATIVE_ADDRESSING_MODE)
     {/* Addressing mode is not Direct register => a word needs to be added */
         if (addressing_mode == IMMEDIATE_ADDRESSING_MODE)
         {
-            /* Create the word representing the immediate addressing mode */
-            immediate_operand_word_to_binary(instruction_line, word_in_binary, is_destination_operand);
-            /* Add word to code table */
-            add_to_code_table(code, IC, word_in_binary, NULL);
+            /* Create the word representing the immediate addressing mode, and add it to code table */
+            add_to_code_table(code, IC, immediate_operand_word_to_binary(instruction_line, is_destination_operand));
         }
         else
         {
             /*
              * Create an empty word (Because Direct and Relative addressing modes can be implemented only in second pass)
-             * Save the label name for the second pass, and add the word to the code table
+             * and a fixup record with the label name (+1 to skip the '&' character of relative addressing mode) and the addressing mode
              */
-            initialize_array_with_zeros(word_in_binary, WORD_SIZE);
-            if (is_destination_operand)
-                add_to_code_table(code, IC, word_in_binary, (*instruction_line)->destination_operand);
-            else
-                add_to_code_table(code, IC, word_in_binary, (*instruction_line)->source_operand);
+            if (addressing_mode == RELATIVE_ADDRESSING_MODE)
+                operand++;
+            add_fixup_to_code_table(code, IC, operand, addressing_mode);
         }
     }
 }
 
-void immediate_operand_word_to_binary(encoded_instruction **instruction_line, char *word_in_binary, int is_destination_operand)
+int immediate_operand_word_to_binary(encoded_instruction **instruction_line, int is_destination_operand)
 {
-    int operand, binary_index = 0, finished_bits = 0;
+    int operand;
 
-    /* Get the decimal value of the operand */
+    /* Get the decimal value of the operand (it was parsed in 'create_encoded_instruction') */
     if (is_destination_operand)
-    {
-        operand = strtol((*instruction_line)->destination_operand + 1, NULL, DECIMAL_BASE); /* +1 in order to skip the '#' character */
-    }
+        operand = (*instruction_line)->destination_immediate;
     else
-    {/* Source operand */
-        operand = strtol((*instruction_line)->source_operand + 1, NULL, DECIMAL_BASE); /* +1 in order to skip the '#' character */
-    }
-    /*
-     * Use two's complement representation (if necessary)
-     *     A. [~(-operand) + 1] => Is the two's complement representation of 'operand'
-     *     B. [& ((1 << 21) - 1)] => Ensures 21-bit representation (by performing a bitwise AND operation with a binary number of 21 ones [(1 << 21) - 1])
-     */
-    if (operand < 0)
-        operand = (~(-operand) + 1) & ((1 << ADDITIONAL_WORD_LENGTH_IN_BITS) - 1);
+        /* Source operand */
+        operand = (*instruction_line)->source_immediate;
 
     /*
      * Similar to first_word_to_binary function
+     * ENCODE_OPERAND_VALUE uses two's complement representation for a negative operand (and ensures 21-bit representation)
      */
-    integer_to_binary((*instruction_line)->E, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + E_NUM_OF_BITS - binary_index);
-    finished_bits += E_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->R, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + R_NUM_OF_BITS - binary_index);
-    finished_bits += R_NUM_OF_BITS;
-
-    integer_to_binary((*instruction_line)->A, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + A_NUM_OF_BITS - binary_index);
-    finished_bits += A_NUM_OF_BITS;
-
-    /* Convert 'operand' to binary, and save it */
-    /* Add zeros to fill out the rest of the field (21 bits) */
-    integer_to_binary(operand, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + ADDITIONAL_WORD_LENGTH_IN_BITS - binary_index);
-    finished_bits += ADDITIONAL_WORD_LENGTH_IN_BITS;
-
-    /* Add null terminator */
-    word_in_binary[binary_index] = '\0';
-
-    /* Reverse the string to get the correct binary representation */
-    reverse_string(word_in_binary);
+    return ENCODE_FIELD(E, (*instruction_line)->E) | ENCODE_FIELD(R, (*instruction_line)->R) | ENCODE_FIELD(A, (*instruction_line)->A)
+         | ENCODE_OPERAND_VALUE(operand);
 }
 
-void directive_to_binary(char **ptr, char *directive_name, code_data_array **data, label_table **label_table, int *DC, int *label_table_lines)
+void directive_to_binary(char **ptr, char *directive_name, word_store *data, symbol_table *symbols, int *DC)
 {
-    char word_in_binary[WORD_SIZE]; /* Array to store the binary representation of a word */
-    char *directive_number = NULL, *directive_string = NULL, *label_name = NULL;  /* Initialize to NULL in order to 'free' an initialized variable */
-    int num_of_data_parameters = 0;
+    char *directive_string, *label_name;
+    int directive_numbers[MAX_DIRECTIVE_NUMBERS_PER_CALL];  /* Buffer for the numbers of a .data directive */
+    int i, num_of_data_parameters = 0, num_of_numbers, directive_string_length;
 
     if (strcmp(directive_name, ".data") == 0)
     {/* .data directive */
-        directive_number = get_next_directive_number(ptr, 0);
-        while (directive_number != NULL)
-        {/* While there are numbers in the line */
-            num_of_data_parameters++;
-            /* Convert the directive number to binary and add it to the data table */
-            directive_number_to_binary(directive_number, word_in_binary);
-            add_to_data_table(data, DC, word_in_binary);
-            /* Get the next number */
-            directive_number = get_next_directive_number(ptr, 1);
-        }
+        do
+        {/* Parse a batch of numbers (a whole line fits in one batch), then add them to the data table */
+            num_of_numbers = get_directive_numbers(ptr, directive_numbers, MAX_DIRECTIVE_NUMBERS_PER_CALL, num_of_data_parameters == 0 ? 0 : 1);
+            for (i = 0; i < num_of_numbers; i++)
+            {/* Encode each directive number and add it to the data table */
+                add_to_data_table(data, DC, directive_number_to_binary(directive_numbers[i]));
+            }
+            num_of_data_parameters += num_of_numbers;
+        } while (num_of_numbers == MAX_DIRECTIVE_NUMBERS_PER_CALL);
 
         if (num_of_data_parameters == 0)
         {/* .data directive must contain at least one number */
@@ -230,122 +145,115 @@ void directive_to_binary(char **ptr, char *directive_name, code_data_array **dat
     }
     else if (strcmp(directive_name, ".string") == 0)
     {/* .string directive */
-        directive_string = get_directive_string(ptr);
+        directive_string = get_directive_string(ptr, &directive_string_length);
         if (directive_string != NULL)
-            /* Convert the directive string to binary and add it to the data table */
-            insert_directive_string_into_data_table(directive_string, word_in_binary, data, DC);
+            /* Encode the directive string and add it to the data table */
+            insert_directive_string_into_data_table(directive_string, directive_string_length, data, DC);
 
         /* Print error if extra characters are found at the end of the line */
         check_no_extra_chars(ptr);
     }
+    else if (strcmp(directive_name, ".space") == 0 || strcmp(directive_name, ".fill") == 0)
+    {/* .space N => N words of 0,  .fill N, value => N words of 'value' */
+        num_of_numbers = get_directive_numbers(ptr, directive_numbers, MAX_DIRECTIVE_NUMBERS_PER_CALL, 0);
+        if (num_of_numbers != (strcmp(directive_name, ".space") == 0 ? 1 : 2))
+        {/* .space takes only a size, and .fill takes a size and a value */
+            print_error(ERROR_42, AM_FILE_STAGE);
+        }
+        else if (directive_numbers[0] <= 0)
+        {/* The size must be positive */
+            print_error(ERROR_43, AM_FILE_STAGE);
+        }
+        else if (directive_numbers[0] > MAX_NUM_OF_WORDS - *DC)
+        {/* Check the size before the run is added (like .incbin, a run may not pass the end of the memory) */
+            print_error(ERROR_52, AM_FILE_STAGE);
+        }
+        else
+        {/* The words are added as one run (one line in the data table, that is expanded when the object file is written) */
+            add_run_to_data_table(data, DC, num_of_numbers == 2 ? directive_number_to_binary(directive_numbers[1]) : 0, directive_numbers[0]);
+        }
+        /* Print error if extra characters are found at the end of the line */
+        check_no_extra_chars(ptr);
+    }
+    else if (strcmp(directive_name, ".incbin") == 0 || strcmp(directive_name, ".incbinw") == 0)
+    {/* .incbin "file"[, offset[, length]] => a word per byte,  .incbinw => a word per 3 bytes */
+        include_binary_file(ptr, strcmp(directive_name, ".incbin") == 0 ? 1 : BYTES_PER_WORD, data, DC);
+    }
     else if (strcmp(directive_name, ".entry") == 0)
-    {/* .entry directive */
-        /* .entry directive is handled in the second pass => Do nothing */
+    {/* .entry directive => save it for the second pass (the label may be defined later in the file) */
+        label_name = get_label_name_and_advance(ptr);
+        /* Print error if extra characters are found at the end of the line */
+        check_no_extra_chars(ptr);
+        if (label_name != NULL)
+            add_entry_request(symbols, label_name);
     }
     else
     {/* strcmp(directive_name, ".extern") == 0   => .extern directive */
         label_name = get_label_name_and_advance(ptr);
         if (label_name != NULL)
         {/* Label found => add it to label table */
-            add_to_label_table(label_table, 0, label_name, NULL, EXTERN_TYPE, label_table_lines);
+            add_to_label_table(symbols, 0, label_name, EXTERN_FLAG);
         }
         /* Print error if extra characters are found at the end of the line */
         check_no_extra_chars(ptr);
     }
-
-    /* Free allocated memory */
-    free(directive_number);
-    free(directive_string);
 }
 
-char *get_next_directive_number(char **ptr, int num_of_commas_expected)
+int get_directive_numbers(char **ptr, int *numbers, int max_numbers, int num_of_commas_expected)
 {
-    char *directive_number;
-    int num_of_digits = 0; /* num_of_digits includes '+' and '-' signs */
+    int num_of_numbers = 0;
+    int number_length;   /* number_length includes '+' and '-' signs */
     int commas_count;
 
-    commas_count = skip_whitespaces_and_commas(ptr);
-    if (**ptr != '\0' && **ptr != '\n')
-    {/* We are not at the end of the line */
+    while (num_of_numbers < max_numbers)
+    {
+        commas_count = skip_whitespaces_and_commas(ptr);
+        if (**ptr == '\0' || **ptr == '\n')
+            /* We have reached the end of the line => No more numbers */
+            break;
+
         if (commas_count != num_of_commas_expected)
         {/* Invalid number of commas between parameters/names */
             print_error(ERROR_21, AM_FILE_STAGE);
         }
-    }
-    else
-        /* We have reached the end of the line => No more numbers */
-        return NULL;
 
-    /* Find the length of the next directive number */
-    while (!isspace(*(*ptr + num_of_digits)) && *(*ptr + num_of_digits) != ',' && *(*ptr + num_of_digits) != '\n' && *(*ptr + num_of_digits) != '\0')
-    {/* While integer end is not reached */
-        /* Increment label_length */
-        num_of_digits++;
-    }
+        /* Find the length of the next directive number (it ends with: whitespace, comma, newline, null terminator) */
+        number_length = find_char_of_class(*ptr, WHITESPACE_CHAR_CLASS | COMMA_CHAR_CLASS) - *ptr;
 
-    /* Allocate memory for directive_number */
-    directive_number = malloc((num_of_digits + 1) * sizeof(char));  /* +1 for \0 */
-
-    /* Copy integer into directive_number */
-    strncpy(directive_number, *ptr, num_of_digits);
-    *(directive_number + num_of_digits) = '\0';  /* Null termination */
-
-    /* Update pointer location */
-    *ptr += num_of_digits;
+        /* Validate and convert the number in place (a number in the data table takes a whole word) */
+        if (!parse_number(*ptr, number_length, WORD_SIZE, numbers + num_of_numbers))
+        {/* Not a valid number (error was already printed) => stop parsing the line */
+            *ptr += number_length;
+            break;
+        }
 
-    if (!is_valid_number(directive_number))
-    {/* directive_number is not a valid number */
-        free(directive_number);
-        return NULL;
+        /* Update pointer location */
+        *ptr += number_length;
+        num_of_numbers++;
+        /* Every number after the first one must be preceded by one comma */
+        num_of_commas_expected = 1;
     }
-    return directive_number;
+    return num_of_numbers;
 }
 
-void directive_number_to_binary(char *directive_number, char *word_in_binary)
+int directive_number_to_binary(int directive_number)
 {
-    int integer, binary_index = 0;
-    if (isalpha(directive_number[0]))
-        /* First character is a letter => get its ascii value */
-        integer = (int)directive_number[0];
-    else
-        /* String represents a number => get the number */
-        integer = strtol(directive_number, NULL, DECIMAL_BASE);
-
     /*
      * Use two's complement representation (if necessary)
-     *     A. [~(-integer) + 1] => Is the two's complement representation of 'integer'
-     *     B. [& ((1 << 24) - 1)] => Ensures 24-bit representation (by performing a bitwise AND operation with a binary number of 24 ones [(1 << 24) - 1])
-     */
-    if (integer < 0)
-        integer = (~(-integer) + 1) & ((1 << WORD_SIZE) - 1);
-
-    /*
-     * Similar to first_word_to_binary function.
-     *
-     * Convert 'integer' to binary, and save it
-     * Add zeros to fill out the rest of the field (24 bits)
+     * [& ((1 << 24) - 1)] => Ensures 24-bit representation (by performing a bitwise AND operation with a binary number of 24 ones [(1 << 24) - 1])
      */
-    integer_to_binary(integer, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, WORD_SIZE - binary_index);
-
-    /* Add null terminator */
-    word_in_binary[binary_index] = '\0';
-
-    /* Reverse the string to get the correct binary representation */
-    reverse_string(word_in_binary);
+    return (int)(directive_number & BITS_MASK(WORD_SIZE));
 }
 
-char *get_directive_string(char **ptr)
+char *get_directive_string(char **ptr, int *directive_string_length)
 {
     char *directive_string;
-    int directive_string_length = 0;
     int error_found = 0;  /* Error found in directive string: 0 - No error, 1 - Missing " at the beginning, 2 - Non-ASCII char, 3 - Missing " at the end */
 
     /* Skip whitespaces */
-    while (isspace(**ptr))
-        (*ptr)++;
+    *ptr = skip_chars_of_class(*ptr, WHITESPACE_CHAR_CLASS);
 
-    if (**ptr != '"')
+    if (!IS_OF_CHAR_CLASS(**ptr, QUOTE_CHAR_CLASS))
     {/* A valid directive string must start with a " char */
         print_error(ERROR_24, AM_FILE_STAGE);
         error_found = 1;
@@ -353,146 +261,159 @@ char *get_directive_string(char **ptr)
     else
         (*ptr)++;  /* Skip the " char */
 
-    /* Find the number of characters in the directive string */
-    while (*(*ptr + directive_string_length) != '"' && *(*ptr + directive_string_length) != '\n' && *(*ptr + directive_string_length) != '\0')
-    {/* While neither " nor string end is reached */
-        if (!is_ascii(*(*ptr + directive_string_length)) && error_found != 2) /* [&& error_found != 2] in order to print the error message only once */
-        {/* A valid directive string must contain only ASCII characters */
-            print_error(ERROR_25, AM_FILE_STAGE);
-            error_found = 2;
-        }
-        /* Increment directive_string_length */
-        directive_string_length++;
+    /* The directive string is the span until the closing " (or the end of the line), it is not copied */
+    directive_string = *ptr;
+    *directive_string_length = strcspn(directive_string, "\"\n");
+
+    /* Validate the whole span at once */
+    if (!is_ascii_span(directive_string, *directive_string_length))
+    {/* A valid directive string must contain only ASCII characters */
+        print_error(ERROR_25, AM_FILE_STAGE);
+        error_found = 2;
     }
 
-    if (*(*ptr + directive_string_length) != '"')
+    /* Update pointer location */
+    *ptr += *directive_string_length;
+
+    if (!IS_OF_CHAR_CLASS(**ptr, QUOTE_CHAR_CLASS))
     {/* A valid directive string must end with a " char */
         print_error(ERROR_26, AM_FILE_STAGE);
         error_found = 3;
     }
-
-    /* Allocate memory for directive_string */
-    directive_string = malloc((directive_string_length + 1) * sizeof(char));  /* +1 for the char \0 */
-
-    /* Copy string into directive_string */
-    strncpy(directive_string, *ptr, directive_string_length);
-    *(directive_string + directive_string_length) = '\0';  /* Null termination */
-
-    /* Update pointer location */
-    *ptr += directive_string_length + 1;  /* +1 to skip the last " char */
+    else
+        (*ptr)++;  /* Skip the last " char */
 
     if (error_found)
-    {/* directive string is not valid */
-        free(directive_string);
+        /* directive string is not valid */
         return NULL;
-    }
     return directive_string;
 }
 
-void insert_directive_string_into_data_table(char *directive_string, char *word_in_binary, code_data_array **data, int *DC)
+void insert_directive_string_into_data_table(char *directive_string, int directive_string_length, word_store *data, int *DC)
 {
-    int i = 0;
-    char string_char[2]; /* Array that contains one character and a null terminator */
+    int i;
+    /* Reserve the cells of all the characters and the '\0' at once (+1 for the '\0') */
+    int *words = add_cells_to_data_table(data, DC, directive_string_length + 1);
 
-    /* Insert each character of the directive string into the data table */
-    while (directive_string[i] != '\0')
-    {
-        string_char[0] = directive_string[i++];     /* Get the next character */
-        string_char[1] = '\0';                      /* Null termination */
-        /* Convert the character to binary and add it to the data table */
-        directive_number_to_binary(string_char, word_in_binary);
-        add_to_data_table(data, DC, word_in_binary);
-    }
+    /* Each character is stored in a word (its value is its ASCII code) */
+    for (i = 0; i < directive_string_length; i++)
+        words[i] = directive_number_to_binary((unsigned char)directive_string[i]);
 
     /* Add '\0' into data table */
-    string_char[0] = '\0';                          /* Add null terminator (as the value) */
-    string_char[1] = '\0';                          /* Null termination */
-    directive_number_to_binary(string_char, word_in_binary);
-    add_to_data_table(data, DC, word_in_binary);
+    words[directive_string_length] = directive_number_to_binary('\0');
 }
 
-void direct_operand_word_to_binary(int address, char *word_in_binary)
+void include_binary_file(char **ptr, int bytes_per_word, word_store *data, int *DC)
 {
-    int A, R, E, binary_index = 0, finished_bits = 0;
-
-    if (address == 0)
-    {/* External address */
-        A = 0;
-        R = 0;
-        E = 1;
-    }
-    else
-    {/* Internal address */
-        A = 0;
-        R = 1;
-        E = 0;
+    char binary_file_name[MAX_LINE_LENGTH];  /* The name is a part of the line => it is shorter than a line */
+    char *directive_string;
+    int directive_string_length, num_of_numbers, numbers[MAX_DIRECTIVE_NUMBERS_PER_CALL];
+    long offset, length, file_size;
+    int num_of_words;
+    FILE *binary_file;
+
+    /* The file name is written as a string (in quotes) */
+    directive_string = get_directive_string(ptr, &directive_string_length);
+    if (directive_string == NULL)
+        /* Invalid string (error was already printed) */
+        return;
+    strncpy(binary_file_name, directive_string, directive_string_length);
+    binary_file_name[directive_string_length] = '\0';  /* Null termination */
+
+    /* Optional offset and length (each one is preceded by a comma) */
+    num_of_numbers = get_directive_numbers(ptr, numbers, MAX_DIRECTIVE_NUMBERS_PER_CALL, 1);
+    /* Print error if extra characters are found at the end of the line */
+    check_no_extra_chars(ptr);
+    if (num_of_numbers > 2 || (num_of_numbers >= 1 && numbers[0] < 0) || (num_of_numbers == 2 && numbers[1] < 0))
+    {/* Too many parameters, or a negative offset/length */
+        print_error(ERROR_45, AM_FILE_STAGE);
+        return;
     }
 
-    /*
-     * Similar to first_word_to_binary function
-     */
-    integer_to_binary(E, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + E_NUM_OF_BITS - binary_index);
-    finished_bits += E_NUM_OF_BITS;
+    binary_file = fopen(binary_file_name, "rb");
+    if (binary_file == NULL)
+    {
+        print_error(ERROR_44, AM_FILE_STAGE);
+        return;
+    }
 
-    integer_to_binary(R, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + R_NUM_OF_BITS - binary_index);
-    finished_bits += R_NUM_OF_BITS;
+    /* Find the size of the file, and the part of it that is included */
+    fseek(binary_file, 0, SEEK_END);
+    file_size = ftell(binary_file);
+    offset = (num_of_numbers >= 1) ? numbers[0] : 0;
+    length = (num_of_numbers == 2) ? numbers[1] : file_size - offset;
 
-    integer_to_binary(A, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + A_NUM_OF_BITS - binary_index);
-    finished_bits += A_NUM_OF_BITS;
+    if (offset > file_size || length > file_size - offset)
+    {/* The included part must be inside the file */
+        print_error(ERROR_45, AM_FILE_STAGE);
+    }
+    else if (*DC + (length + bytes_per_word - 1) / bytes_per_word > MAX_NUM_OF_WORDS)
+    {/* Check the size before anything is read (the last word is padded with zeros if needed) */
+        print_error(ERROR_46, AM_FILE_STAGE);
+    }
+    else
+    {/* Reserve all the words at once, and fill them straight from the file (without any text parsing) */
+        num_of_words = (int)((length + bytes_per_word - 1) / bytes_per_word);
+        fseek(binary_file, offset, SEEK_SET);
+        read_binary_words(binary_file, length, bytes_per_word, add_cells_to_data_table(data, DC, num_of_words));
+    }
 
-    /* Convert 'address' to binary, and save it */
-    /* Add zeros to fill out the rest of the field (21 bits) */
-    integer_to_binary(address, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + ADDITIONAL_WORD_LENGTH_IN_BITS - binary_index);
-    finished_bits += ADDITIONAL_WORD_LENGTH_IN_BITS;
+    fclose(binary_file);
+}
 
-    /* Add null terminator */
-    word_in_binary[binary_index] = '\0';
+void read_binary_words(FILE *binary_file, long length, int bytes_per_word, int *words)
+{
+    unsigned char buffer[INCBIN_BUFFER_SIZE];
+    size_t bytes_read, i;
+    int word = 0, bytes_in_word = 0;
+
+    while (length > 0)
+    {/* Read the file in blocks */
+        bytes_read = fread(buffer, 1, (length < INCBIN_BUFFER_SIZE) ? (size_t)length : INCBIN_BUFFER_SIZE, binary_file);
+        if (bytes_read == 0)
+            /* The file is shorter than expected (the rest of the words stay 0) */
+            break;
+        length -= (long)bytes_read;
+
+        for (i = 0; i < bytes_read; i++)
+        {/* Pack the bytes into words (the first byte is the most significant one) */
+            word = (word << BITS_PER_BYTE) | buffer[i];
+            if (++bytes_in_word == bytes_per_word)
+            {/* The word is complete */
+                *words++ = word;
+                word = 0;
+                bytes_in_word = 0;
+            }
+        }
+    }
 
-    /* Reverse the string to get the correct binary representation */
-    reverse_string(word_in_binary);
+    if (bytes_in_word > 0)
+        /* Pad the last word with zeros */
+        *words = word << (BITS_PER_BYTE * (bytes_per_word - bytes_in_word));
 }
 
-void relative_operand_word_to_binary(int jumping_distance, char *word_in_binary)
+int direct_operand_word_to_binary(int address, int is_external)
 {
-    int A, R, E, binary_index = 0, finished_bits = 0;
+    int ARE;
 
-    /* In relative addressing mode: A,R,E are always 1,0,0 */
-    A = 1;
-    R = 0;
-    E = 0;
+    if (is_external)
+    {/* External address: A=0, R=0, E=1 (the address is filled by the linker) */
+        ARE = ENCODE_FIELD(E, 1);
+        address = 0;
+    }
+    else
+        /* Internal address: A=0, R=1, E=0 */
+        ARE = ENCODE_FIELD(R, 1);
 
-    /* Use two's complement representation (if necessary) - As explained in the 'immediate_operand_word_to_binary' function */
-    if (jumping_distance < 0)
-        jumping_distance = (~(-jumping_distance) + 1) & ((1 << ADDITIONAL_WORD_LENGTH_IN_BITS) - 1);
+    /* Similar to first_word_to_binary function */
+    return ARE | ENCODE_OPERAND_VALUE(address);
+}
 
+int relative_operand_word_to_binary(int jumping_distance)
+{
     /*
-     * Similar to first_word_to_binary function
+     * In relative addressing mode: A,R,E are always 1,0,0
+     * ENCODE_OPERAND_VALUE uses two's complement representation for a negative distance (as in the 'immediate_operand_word_to_binary' function)
      */
-    integer_to_binary(E, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + E_NUM_OF_BITS - binary_index);
-    finished_bits += E_NUM_OF_BITS;
-
-    integer_to_binary(R, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + R_NUM_OF_BITS - binary_index);
-    finished_bits += R_NUM_OF_BITS;
-
-    integer_to_binary(A, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + A_NUM_OF_BITS - binary_index);
-    finished_bits += A_NUM_OF_BITS;
-
-    /* Convert 'jumping_distance' to binary, and save it */
-    /* Add zeros to fill out the rest of the field (21 bits) */
-    integer_to_binary(jumping_distance, word_in_binary, &binary_index);
-    add_zeros(word_in_binary, &binary_index, finished_bits + ADDITIONAL_WORD_LENGTH_IN_BITS - binary_index);
-    finished_bits += ADDITIONAL_WORD_LENGTH_IN_BITS;
-
-    /* Add null terminator */
-    word_in_binary[binary_index] = '\0';
-
-    /* Reverse the string to get the correct binary representation */
-    reverse_string(word_in_binary);
+    return ENCODE_FIELD(A, 1) | ENCODE_OPERAND_VALUE(jumping_distance);
 }
\ No newline at end of file
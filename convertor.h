@@ -4,39 +4,6 @@
 
 #include "first_pass.h"
 
-/**
- * Adds a specified number of zeros to a binary word representation.
- * This function appends the required number of '0' characters to the word_in_binary string
- * at the position indicated by binary_index. It then updates the binary_index pointer to
- * point to the position immediately after the last zero added.
- *
- * Input:
- *   - word_in_binary: The string representing the binary word being constructed
- *   - binary_index: Pointer to the current position in the binary word
- *   - required_zeros: Number of '0' characters to add
- *
- * Output:
- *   - No return value
- */
-void add_zeros(char *word_in_binary, int *binary_index, int required_zeros);
-
-
-/**
- * Converts an integer value to its binary representation,
- * stores it in the provided string,
- * and updated the position of the binary_index pointer.
- *
- * Input:
- *   - num: Integer value to convert to binary
- *   - word_in_binary: String where the binary representation will be stored
- *   - binary_index: Pointer to current position in the binary word
- *
- * Output:
- *   - No return value
- */
-void integer_to_binary(int num, char *word_in_binary, int *binary_index);
-
-
 /**
  * Converts an instruction to its binary representation and stores it in the code array.
  * This function processes an encoded instruction structure and generates the appropriate
@@ -50,21 +17,22 @@ void integer_to_binary(int num, char *word_in_binary, int *binary_index);
  * Output:
  *   - No return value
  */
-void instruction_to_binary(encoded_instruction **instruction_line, code_data_array **code, int *IC);
+void instruction_to_binary(encoded_instruction **instruction_line, word_store *code, int *IC);
 
 
 /**
  * Converts the first word of an instruction to its binary representation.
- * This function takes an encoded instruction and generates the binary code for the first word.
+ * This function takes an encoded instruction and places each of its fields in the first word
+ * (the fields are defined in FIRST_WORD_FIELDS in isa_spec.h) using the first word template of the instruction
+ * and pre-shifted tables of the operand fields.
  *
  * Input:
  *   - instruction_line: Pointer to the pointer of the encoded instruction structure
- *   - word_in_binary: Character array where the binary representation will be stored
  *
  * Output:
- *   - No return value
+ *   - Returns the encoded word
  */
-void first_word_to_binary(encoded_instruction **instruction_line, char *word_in_binary);
+int first_word_to_binary(encoded_instruction **instruction_line);
 
 
 /**
@@ -74,123 +42,157 @@ void first_word_to_binary(encoded_instruction **instruction_line, char *word_in_
  *   - instruction_line: Pointer to the pointer of the encoded instruction structure
  *   - code: Pointer to the code array where the binary representation will be stored
  *   - IC: Pointer to the Instruction Counter, which will be updated as words are added
- *   - word_in_binary: Character array where the binary representation will be stored
  *   - is_destination_operand: Indicates if the operand is a destination (1) or source (0) operand
  *
  * Output:
  *   - No return value
  */
-void operand_word_to_binary(encoded_instruction **instruction_line, code_data_array **code, int *IC, char *word_in_binary, int is_destination_operand);
+void operand_word_to_binary(encoded_instruction **instruction_line, word_store *code, int *IC, int is_destination_operand);
 
 
 /**
  * Converts an immediate operand to its binary representation.
  * This function handles the conversion of immediate values (operands starting with '#')
- * to their binary representation in the word_in_binary string.
+ * to the word that represents them.
  *
  * Input:
  *   - instruction_line: Pointer to the pointer of the encoded instruction structure
- *   - word_in_binary: Character array where the binary representation will be stored
  *   - is_destination_operand: Indicates if the operand is a destination (1) or source (0) operand
  *
  * Output:
- *   - No return value
+ *   - Returns the encoded word
  */
-void immediate_operand_word_to_binary(encoded_instruction **instruction_line, char *word_in_binary, int is_destination_operand);
+int immediate_operand_word_to_binary(encoded_instruction **instruction_line, int is_destination_operand);
 
 
 /**
  * Converts a data directive to its binary representation and adds it to the data array.
  * This function processes the directive operands and converts them
- * to binary format according to the directive type (.data, .string, .entry, .extern).
+ * to binary format according to the directive type (.data, .string, .space, .fill, .incbin, .incbinw, .entry, .extern).
  *
  * Input:
  *   - ptr: Pointer to the pointer of the line being processed
  *   - directive_name: String containing the directive name
  *   - data: Pointer to the data array where the binary representation will be stored
- *   - label_table: Pointer to the label table
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - DC: Pointer to the Data Counter, which will be updated as data words are added
- *   - label_table_lines: Pointer to the number of label table lines added
  *
  * Output:
  *   - No return value
  */
-void directive_to_binary(char **ptr, char *directive_name, code_data_array **data, label_table **label_table, int *DC, int *label_table_lines);
+void directive_to_binary(char **ptr, char *directive_name, word_store *data, symbol_table *symbols, int *DC);
 
 
 /**
- * Parse and get the next directive number from the input string.
+ * Parses a batch of comma separated numbers of a .data directive from the input string.
+ * Each number is validated, range checked (it must fit in a word) and converted in a single pass.
+ * Parsing stops at the end of the line, at an invalid number, or after 'max_numbers' numbers.
  *
  * Input:
  *   - ptr: Pointer to the pointer of the current position in the line being processed
- *   - num_of_commas_expected: The expected number of commas before this number (for error checking)
+ *   - numbers: Array where the values of the numbers will be stored
+ *   - max_numbers: Maximum number of numbers to parse in this call (the size of 'numbers')
+ *   - num_of_commas_expected: The expected number of commas before the first number of this batch (for error checking)
  *
  * Output:
- *   - Returns a dynamically allocated string containing the extracted number on success
- *   - Returns NULL if an error occurs during parsing
+ *   - Returns the number of valid numbers that were parsed
+ *     (if it equals 'max_numbers' there may be more numbers in the line)
  */
-char *get_next_directive_number(char **ptr, int num_of_commas_expected);
+int get_directive_numbers(char **ptr, int *numbers, int max_numbers, int num_of_commas_expected);
 
 
 /**
- * Converts a directive number (number in a .data directive) to its binary representation.
+ * Converts a directive number (number in a .data directive, or a character in a .string directive) to its binary representation.
  *
  * Input:
- *   - directive_number: String representing the number to be converted
- *   - word_in_binary: Character array where the binary representation will be stored
+ *   - directive_number: The value to be converted
  *
  * Output:
- *   - No return value
+ *   - Returns the encoded word (two's complement is used for negative values)
  */
-void directive_number_to_binary(char *directive_number, char *word_in_binary);
+int directive_number_to_binary(int directive_number);
 
 
 /**
- * Extracts a string literal from a .string directive.
+ * Finds the string literal of a .string directive (without copying it).
  * Validates that the string starts and ends with double quotes and contains only ASCII characters.
  * And updates ptr to point to the position after the closing quote.
  *
  * Input:
  *   - ptr: Pointer to the pointer of the current position in the line being processed
+ *   - directive_string_length: Pointer to where the length of the directive string (without the quotes) will be stored
  *
  * Output:
- *   - Returns a dynamically allocated string containing the extracted directive string on success
+ *   - Returns a pointer to the first character of the directive string (inside the line) on success
  *   - Returns NULL if validation fails (missing quotes or non-ASCII characters)
  */
-char *get_directive_string(char **ptr);
+char *get_directive_string(char **ptr, int *directive_string_length);
 
 
 /**
- * Inserts a directive string character by character into the data table.
- * This function processes each character of the input string (including the null terminator),
- * converts each character to binary representation, and adds it to the data table.
+ * Inserts a directive string into the data table.
+ * This function reserves the cells of all the characters (and the null terminator) in one step,
+ * and stores each character as a word.
  *
  * Input:
- *   - directive_string: The string to be inserted into the data table
- *   - word_in_binary: Character array where the binary representation will be stored
- *   - data: Pointer to the data array where the binary string will be stored
+ *   - directive_string: The string to be inserted into the data table (not null terminated)
+ *   - directive_string_length: The number of characters in the string
+ *   - data: Pointer to the data array where the words will be stored
  *   - DC: Pointer to the Data Counter, which will be updated as data words are added
  *
  * Output:
  *   - No return value
  */
-void insert_directive_string_into_data_table(char *directive_string, char *word_in_binary, code_data_array **data, int *DC);
+void insert_directive_string_into_data_table(char *directive_string, int directive_string_length, word_store *data, int *DC);
+
+
+/**
+ * Handles a .incbin/.incbinw directive: .incbin "file"[, offset[, length]]
+ * The bytes of the file (from 'offset', 'length' bytes - or until the end of the file) are appended to the data table
+ * without any text parsing. The size is checked against MAX_NUM_OF_WORDS before the file is read.
+ *
+ * Input:
+ *   - ptr: Pointer to the pointer of the current position in the line being processed
+ *   - bytes_per_word: 1 for .incbin (a word per byte), BYTES_PER_WORD for .incbinw (packed words)
+ *   - data: Pointer to the data array where the words will be stored
+ *   - DC: Pointer to the Data Counter, which will be updated as data words are added
+ *
+ * Output:
+ *   - No return value
+ */
+void include_binary_file(char **ptr, int bytes_per_word, word_store *data, int *DC);
+
+
+/**
+ * Reads bytes from a binary file and packs them into words (the first byte is the most significant one).
+ * If the number of bytes is not a multiple of 'bytes_per_word', the last word is padded with zeros.
+ *
+ * Input:
+ *   - binary_file: The file (its position is at the first byte to read)
+ *   - length: Number of bytes to read
+ *   - bytes_per_word: Number of bytes in each word
+ *   - words: The data table words where the words will be stored (there must be enough of them)
+ *
+ * Output:
+ *   - No return value
+ */
+void read_binary_words(FILE *binary_file, long length, int bytes_per_word, int *words);
 
 
 /**
  * Converts a direct addressing operand to its binary representation.
  * This function converts the address value into binary format with appropriate ARE bits
- * (A=0, R=1, E=1 for external addresses or A=0, R=1, E=0 for internal addresses).
+ * (A=0, R=0, E=1 for external addresses or A=0, R=1, E=0 for internal addresses).
  * This function is used in second pass (because direct addressing mode can be encoded only after label table was built)
  *
  * Input:
- *   - address: The address value to be converted (0 for external addresses)
- *   - word_in_binary: Character array where the binary representation will be stored
+ *   - address: The address value to be converted (ignored for external addresses - their address field is 0)
+ *   - is_external: Non-zero if the label is external
  *
  * Output:
- *   - No return value
+ *   - Returns the encoded word
  */
-void direct_operand_word_to_binary(int address, char *word_in_binary);
+int direct_operand_word_to_binary(int address, int is_external);
 
 
 /**
@@ -201,12 +203,11 @@ void direct_operand_word_to_binary(int address, char *word_in_binary);
  *
  * Input:
  *   - jumping_distance: The distance to jump (can be positive or negative)
- *   - word_in_binary: Character array where the binary representation will be stored
  *
  * Output:
- *   - No return value
+ *   - Returns the encoded word
  */
-void relative_operand_word_to_binary(int jumping_distance, char *word_in_binary);
+int relative_operand_word_to_binary(int jumping_distance);
 
 
 #endif /* CONVERTOR_H */
\ No newline at end of file
@@ -48,6 +48,18 @@ Error ERRORS[NUM_OF_ERRORS] = {
     {ERROR_38, "NO ERROR - source operand is referenced to as a label (and not as a register)"},
     {ERROR_39, "NO ERROR - destination operand is referenced to as a label (and not as a register)"},
     {ERROR_40, "Macro ending contains extra characters"},
+    {ERROR_41, "Number is out of range"},
+    {ERROR_42, "Invalid number of parameters in .space/.fill directive"},
+    {ERROR_43, "Size of .space/.fill directive must be a positive number"},
+    {ERROR_44, "Cannot open the file of .incbin directive"},
+    {ERROR_45, "Invalid offset/length in .incbin directive"},
+    {ERROR_46, "The file of .incbin directive exceeds the memory size"},
+    {ERROR_47, "Unknown command line option"},
+    {ERROR_48, "Invalid binary object file"},
+    {ERROR_49, "Invalid object/entries/externals file"},
+    {ERROR_50, "The --stream option cannot be combined with --listing or --format=bin"},
+    {ERROR_51, "Writing an output file failed"},
+    {ERROR_52, "Size of .space/.fill directive exceeds the memory size"},
 };
 
 /* Initialization of global variables */
@@ -47,7 +47,19 @@ typedef enum ERROR_NUMBERS {
     ERROR_37,
     ERROR_38,
     ERROR_39,
-    ERROR_40
+    ERROR_40,
+    ERROR_41,
+    ERROR_42,
+    ERROR_43,
+    ERROR_44,
+    ERROR_45,
+    ERROR_46,
+    ERROR_47,
+    ERROR_48,
+    ERROR_49,
+    ERROR_50,
+    ERROR_51,
+    ERROR_52
 } ERROR_NUMBERS;
 
 /** Error structure that contains an error with its message */
@@ -6,6 +6,7 @@
 #include "second_pass.h"
 #include "parser.h"
 #include "errors.h"
+#include "listing.h"
 
 
 /* This class contains the functions that are responsible for the first pass stage of the assembler
@@ -15,20 +16,22 @@
  */
 
 
-int first_pass_stage(char *file_name)
+int first_pass_stage(char *file_name, assembler_options *options)
 {
-    /* 'instruction_line' is used to store the necessary data of the *current* instruction line */
-    encoded_instruction *instruction_line = safe_malloc(sizeof(encoded_instruction));
+    /* 'instructions' is the instruction table
+     * it holds the necessary data of *every* instruction line in the file (one encoded instruction per line)
+     */
+    encoded_instruction *instructions = NULL;        /* Initialize to NULL in order to be able to 'free' at the end (uninitialized variables can't be freed) */
 
-    /* 'code' is the code array, and 'data' is the data array
+    /* 'code' is the code table, and 'data' is the data table
      * they are used to store the machine code and data respectively
      */
-    code_data_array *code = NULL, *data = NULL;      /* Initialize to NULL in order to be able to 'free' at the end (uninitialized variables can't be freed) */
+    word_store code = EMPTY_WORD_STORE, data = EMPTY_WORD_STORE;  /* Start empty (memory is allocated when the first line is added) */
 
-    /* 'label_table' is used to store the label table
-     * it is used to store the labels and their addresses
+    /* 'symbols' is the symbol table
+     * it is used to store the labels and their addresses (and to find a label by its name)
      */
-    label_table *label_table = NULL;                 /* Initialize to NULL in order to prevent future errors */
+    symbol_table symbols;
 
     /* 'externs' is used to store the externs table
      * 'entries' is used to store the entries table
@@ -40,11 +43,15 @@ int first_pass_stage(char *file_name)
      */
     int IC = INITIAL_IC_VALUE, DC = INITIAL_DC_VALUE, ICF, DCF;
 
-    /* 'label_table_lines' is the *current* number of lines in the label table
-     * 'externs_lines' is the *current* number of lines in the externs table
+    /* 'externs_lines' is the *current* number of lines in the externs table
      * 'entries_lines' is the *current* number of lines in the entries table
      */
-    int label_table_lines = 0, externs_lines = 0, entries_lines = 0;
+    int externs_lines = 0, entries_lines = 0;
+
+    /* 'instructions_lines' is the *current* number of lines in the instruction table
+     * 'instructions_capacity' is the number of allocated lines in the instruction table
+     */
+    int instructions_lines = 0, instructions_capacity = 0;
 
     /* 'complete_file_name' is used to store the name of the file with its ending
      * 'am_file' is used to open the file for reading
@@ -59,41 +66,64 @@ int first_pass_stage(char *file_name)
     complete_file_name = get_file_name(2, file_name, ".am");  /* Get the file name with the extension */
     am_file = safe_fopen(complete_file_name, "r");           /* Open the file for reading */
 
+    /* Size the hash index of the symbol table from an estimation of the number of lines (every label is defined in a different line) */
+    init_symbol_table(&symbols, estimate_num_of_lines(am_file));
+    if (options->single_pass || options->stream)
+    {/* Single pass mode => the labels that are referenced before their definition are kept with a chain of their fixups */
+        symbols.forward_references = safe_malloc(sizeof(symbol_table));
+        init_symbol_table(symbols.forward_references, 0);
+    }
+    if (options->stream)
+    {/* Stream mode => the final code and data words are written to temporary files during the first pass (they are deleted when they are closed) */
+        code.spool = tmpfile();
+        data.spool = tmpfile();
+        if (code.spool == NULL || data.spool == NULL)
+            print_error(ERROR_2, INTERNAL_ERROR_STAGE);
+    }
+
     /* This function is responsible for most part in the first pass stage */
-    encode_all_assembly_lines(am_file, &instruction_line, &code, &data, &label_table, &IC, &DC, &label_table_lines);
+    encode_all_assembly_lines(am_file, &instructions, &instructions_lines, &instructions_capacity, &code, &data, &symbols, &IC, &DC, options);
 
     /* Save final IC and DC values */
     ICF = IC;
     DCF = DC;
 
     /* Update label table cells of type data, by adding ICF to their address */
-    update_label_table_cells_of_type_data(&label_table, ICF, label_table_lines);
+    update_label_table_cells_of_type_data(&symbols, ICF);
 
     /* Start second pass */
-    second_pass_stage(&code, &data, &label_table, &entries, &externs, ICF, DCF, label_table_lines, &entries_lines, &externs_lines, file_name, am_file);
+    second_pass_stage(&code, &data, &symbols, &entries, &externs, ICF, DCF, &entries_lines, &externs_lines, file_name, options);
+
+    if (options->listing && current_error_number == ERROR_0)
+        /* Create the listing file (from the tables, and the lines of the ".am" file) */
+        create_listing_file(file_name, am_file, instructions, instructions_lines, &code, &data, ICF, DCF);
 
     /* Here are some printing functions if someone desires */
-    /*print_label_table_cells(label_table, label_table_lines);
-      print_code_data_table_cells(code, IC-INITIAL_IC_VALUE);
-      print_code_data_table_cells(data, DC);
+    /*print_label_table_cells(&symbols);
+      print_code_data_table_cells(&code, INITIAL_IC_VALUE);
+      print_code_data_table_cells(&data, INITIAL_DC_VALUE);
       print_entries_table_cells(entries, entries_lines);
       print_externs_table_cells(externs, externs_lines);*/
 
     /* Free allocated space, and close open files */
-    free(instruction_line);
-    free(label_table);
-    free(code);
-    free(data);
+    free_instruction_table(instructions, instructions_lines);
+    free_symbol_table(&symbols);
+    free_word_store(&code);
+    free_word_store(&data);
     free(externs);
     free(entries);
     fclose(am_file);
     free(complete_file_name);
 
+    if (options->stream)
+        /* Report the memory usage of stream mode (the peak of the whole process so far) */
+        print_peak_memory_usage();
+
     /* Return the error number */
     return current_error_number;
 }
 
-void encode_all_assembly_lines(FILE *file, encoded_instruction **instruction_line, code_data_array **code, code_data_array **data, label_table **label_table, int *IC, int *DC, int *label_table_lines)
+void encode_all_assembly_lines(FILE *file, encoded_instruction **instructions, int *instructions_lines, int *instructions_capacity, word_store *code, word_store *data, symbol_table *symbols, int *IC, int *DC, assembler_options *options)
 {
     char line[MAX_LINE_LENGTH];         /* Buffer to store the current line */
     char *ptr;                          /* Pointer to the current character in the line */
@@ -104,24 +134,19 @@ void encode_all_assembly_lines(FILE *file, encoded_instruction **instruction_lin
         /* Update current line number */
         current_line_number++;
 
-        /* Pointer to the beginning of the line */
-        ptr = line;
-
-        while (isspace(*ptr))
-        {/* Skip all whitespaces (for 'Empty line' check) */
-            ptr++;
-        }
+        /* Skip all whitespaces (for 'Empty line' check) */
+        ptr = skip_chars_of_class(line, WHITESPACE_CHAR_CLASS);
         if (*ptr == '\n' || *ptr == '\0')
         {/* Empty line => skip it */
             continue;
         }
 
-        if (*ptr == ';')
+        if (IS_OF_CHAR_CLASS(*ptr, SEMICOLON_CHAR_CLASS))
         {/* Comment line => skip it */
             continue;
         }
 
-        if (strchr(ptr, ':') != NULL)
+        if (*find_char_of_class(ptr, COLON_CHAR_CLASS) != '\0')
         {/* Label declaration in current line (contains ':') => check if label is valid */
             /* Check if label is valid and print error messages if errors found */
             check_validity_of_label_name(&ptr);
@@ -140,21 +165,22 @@ void encode_all_assembly_lines(FILE *file, encoded_instruction **instruction_lin
 
         if (*ptr == '.')
         {/* Directive => encode it (if valid) */
-            encode_directive(&ptr, line, data, label_table, DC, label_table_lines);
+            encode_directive(&ptr, line, data, symbols, DC, options);
         }
 
         else
         {/* Instruction => encode it (if valid) */
-            encode_instruction(&ptr, line, instruction_line, code, label_table, IC, label_table_lines);
+            encode_instruction(&ptr, line, instructions, instructions_lines, instructions_capacity, code, symbols, IC, options);
         }
     }
     /* Reset current line number */
     current_line_number = 0;
 }
 
-void encode_directive(char **ptr, char *line, code_data_array **data, label_table **label_table, int *DC, int *label_table_lines)
+void encode_directive(char **ptr, char *line, word_store *data, symbol_table *symbols, int *DC, assembler_options *options)
 {
     char *directive_name = NULL, *label_name;  /* Label name (if exists) */
+    int first_address;                         /* The data counter before the directive is encoded */
 
     directive_name = get_directive_name(ptr);  /* No need to free directive_name_name because it points to a value in DIRECTIVES [that is available through the whole program] */
 
@@ -168,21 +194,31 @@ void encode_directive(char **ptr, char *line, code_data_array **data, label_tabl
     label_name = get_label_name(line);
     if (label_name != NULL)
     {/* Label found => add it to label table */
-        /* Add label only if it is a data or string directive (labels before entry and extern directives are ignored) */
-        if (strcmp(directive_name, ".data") == 0 || strcmp(directive_name, ".string") == 0)
-            add_to_label_table(label_table, *DC, label_name, DATA_TYPE, NULL, label_table_lines);
+        /* Add label only if it is a directive that adds data (labels before entry and extern directives are ignored) */
+        if (strcmp(directive_name, ".entry") != 0 && strcmp(directive_name, ".extern") != 0)
+            add_to_label_table(symbols, *DC, label_name, DATA_FLAG | DEFINED_FLAG);
         else
             print_error(ERROR_9, AM_FILE_STAGE);
     }
 
     /* Convert the directive to its binary machine code and save it in the data array */
-    directive_to_binary(ptr ,directive_name, data, label_table, DC, label_table_lines);
+    first_address = *DC;
+    directive_to_binary(ptr ,directive_name, data, symbols, DC);
+    if (options->listing && *DC != first_address)
+        /* Save the address of the line's words (only the listing file needs them) */
+        add_line_address(data, first_address);
+    if (data->spool != NULL && data->lines >= STREAM_FLUSH_WORDS)
+        /* Stream mode => the data words are final as soon as they are encoded (nothing refers to them) => write them */
+        write_data_words_to_spool(data);
 }
 
-void encode_instruction(char **ptr, char *line, encoded_instruction **instruction_line, code_data_array **code, label_table **label_table, int *IC, int *label_table_lines)
+void encode_instruction(char **ptr, char *line, encoded_instruction **instructions, int *instructions_lines, int *instructions_capacity, word_store *code, symbol_table *symbols, int *IC, assembler_options *options)
 {
     int instr_num_of_args;
+    int first_new_fixup;                    /* Index of the first fixup of the current instruction */
     char *instr_name, *instr_source_operand = NULL, *instr_destination_operand = NULL;
+    char *label_name;                       /* The name of the label of the line in the label table */
+    encoded_instruction *instruction_line;  /* The line of the current instruction in the instruction table */
 
     instr_name = get_instruction_name(ptr); /* No need to free instr_name because it points to a value in INSTRUCTIONS [that is available through the whole program] */
 
@@ -223,8 +259,11 @@ void encode_instruction(char **ptr, char *line, encoded_instruction **instructio
     /* Print error if extra characters are found at the end of the line */
     check_no_extra_chars(ptr);
 
-    /* Save the instruction line's data in the instruction_line structure for later use (conversion to binary) */
-    create_encoded_instruction(instr_name, instr_source_operand, instr_destination_operand, instr_num_of_args, line, instruction_line);
+    /* Save the instruction line's data in a new line of the instruction table for later use (conversion to binary) */
+    instruction_line = add_to_instruction_table(instructions, instructions_lines, instructions_capacity);
+    create_encoded_instruction(instr_name, instr_source_operand, instr_destination_operand, instr_num_of_args, line, &instruction_line);
+    instruction_line->address = *IC;
+    instruction_line->line_number = current_line_number;
 
     /* Print errors for invalid instruction operands */
     if (instr_source_operand != NULL)
@@ -233,7 +272,7 @@ void encode_instruction(char **ptr, char *line, encoded_instruction **instructio
         {/* Missing source operand */
             print_error(ERROR_30, AM_FILE_STAGE);
         }
-        else if (invalid_instruction_operand_type(instr_name, (*instruction_line)->source_addressing_mode, 1))
+        else if (invalid_instruction_operand_type(instr_name, instruction_line->source_addressing_mode, 1))
         {/* Invalid source operand type */
             print_error(ERROR_28, AM_FILE_STAGE);
         }
@@ -244,39 +283,61 @@ void encode_instruction(char **ptr, char *line, encoded_instruction **instructio
         {/* Missing destination operand */
             print_error(ERROR_31, AM_FILE_STAGE);
         }
-        else if (invalid_instruction_operand_type(instr_name, (*instruction_line)->destination_addressing_mode, 0))
+        else if (invalid_instruction_operand_type(instr_name, instruction_line->destination_addressing_mode, 0))
         {/* Invalid destination operand type */
             print_error(ERROR_29, AM_FILE_STAGE);
         }
     }
 
-    if ((*instruction_line)->label != NULL)
+    if (instruction_line->label != NULL)
     {/* Label found => add it to label table */
-        add_to_label_table(label_table, *IC, (*instruction_line)->label, CODE_TYPE, NULL, label_table_lines);
+        /* Stream mode => the instruction line is freed after it is encoded, so the label table keeps its own copy of the name */
+        label_name = options->stream ? add_to_name_pool(symbols, instruction_line->label) : instruction_line->label;
+        add_to_label_table(symbols, *IC, label_name, CODE_FLAG | DEFINED_FLAG);
+        if (symbols->forward_references != NULL)
+            /* Single pass mode => patch the earlier references to the label */
+            backpatch_label(code, symbols, label_name);
     }
 
     /* Reset the source and destination addressing modes to 0 if they are GARBAGE_VALUE (in order to avoid a future error) */
-    if ((*instruction_line)->source_addressing_mode == GARBAGE_VALUE)
-        (*instruction_line)->source_addressing_mode = 0;
-    if ((*instruction_line)->destination_addressing_mode == GARBAGE_VALUE)
-        (*instruction_line)->destination_addressing_mode = 0;
+    if (instruction_line->source_addressing_mode == GARBAGE_VALUE)
+        instruction_line->source_addressing_mode = 0;
+    if (instruction_line->destination_addressing_mode == GARBAGE_VALUE)
+        instruction_line->destination_addressing_mode = 0;
 
     /* Convert the instruction to its binary machine code and save it in the code array */
-    instruction_to_binary(instruction_line, code, IC);
+    first_new_fixup = code->fixups_lines;
+    instruction_to_binary(&instruction_line, code, IC);
+    if (symbols->forward_references != NULL)
+        /* Single pass mode => resolve the label operands of the instruction now (if their labels are already defined) */
+        resolve_new_fixups(code, symbols, first_new_fixup, options->stream);
+
+    if (options->stream)
+    {/* Stream mode => write the words that are final, and free the instruction line (nothing refers to its strings anymore) */
+        if (code->spool != NULL)
+            flush_resolved_code_words(code);
+        free_instruction_table(*instructions, *instructions_lines);
+        *instructions = NULL;
+        *instructions_lines = *instructions_capacity = 0;
+    }
 }
 
 void create_encoded_instruction(char *instr_name, char *instr_source_operand, char *instr_destination_operand, int instr_num_of_args, char *line, encoded_instruction **instruction_line)
 {
     /* Insert data of current instruction line into encoded_instruction structure */
     (*instruction_line)->opcode = get_instruction_opcode(instr_name);
-    (*instruction_line)->source_addressing_mode = get_addressing_mode(instr_name, instr_source_operand); /* Result according to parsing */
+    /* The values of immediate operands are parsed together with their addressing mode (and stay 0 for other operands) */
+    (*instruction_line)->source_immediate = 0;
+    (*instruction_line)->destination_immediate = 0;
+    (*instruction_line)->source_addressing_mode = get_addressing_mode(instr_name, instr_source_operand, &(*instruction_line)->source_immediate); /* Result according to parsing */
     (*instruction_line)->source_register = get_register_number(instr_source_operand, 1);
-    (*instruction_line)->destination_addressing_mode = get_addressing_mode(instr_name, instr_destination_operand);
+    (*instruction_line)->destination_addressing_mode = get_addressing_mode(instr_name, instr_destination_operand, &(*instruction_line)->destination_immediate);
     (*instruction_line)->destination_register = get_register_number(instr_destination_operand, 0);
     (*instruction_line)->funct = get_instruction_funct(instr_name);
     (*instruction_line)->A = 1;
     (*instruction_line)->R = 0;
     (*instruction_line)->E = 0;
+    (*instruction_line)->first_word_template = get_instruction_first_word_template(instr_name);
     (*instruction_line)->label = get_label_name(line);
     (*instruction_line)->num_of_args = instr_num_of_args;
 
@@ -4,15 +4,61 @@
 
 #include "general_header.h"
 
-/** Structure to hold machine code for code/data tables */
-typedef struct code_data_array {
-    int address;
-    int machine_code;  /* Is equal to the decimal representation of the binary representation of a 'word' */
-    char *label;       /* Is stored if current line represents an operand that is a label */
-    int line_number;   /* Is used for error checking in 'update_machine_code_of_label_operands' (therefore it is saved only for the code table) */
-} code_data_array;
-
-/** Structure to hold all required data for a specific instruction line in order to convert and add it to the code table */
+/** A fixup: a word of the code table that references a label operand (the word is encoded in the second pass, when the label table is complete) */
+typedef struct fixup {
+    int index;        /* Index of the word in the code table */
+    char *label;      /* The label name (without the '&' of the relative addressing mode) */
+    int kind;         /* DIRECT_ADDRESSING_MODE or RELATIVE_ADDRESSING_MODE (RESOLVED_FIXUP if it was resolved in the first pass) */
+    int line_number;  /* Line number in the ".am" file (for error messages in the second pass) */
+    int next;         /* The next fixup of the same undefined label (single pass mode), or NO_FIXUP */
+} fixup;
+
+/** A line of the data spool (stream mode): a word and the number of addresses it fills (1, or the size of a .space/.fill run) */
+typedef struct data_spool_line {
+    int repeat_count;
+    int word;
+} data_spool_line;
+
+/** A run of identical words in the data table (.space/.fill) */
+typedef struct word_run {
+    int index;         /* Index of the line in the data table */
+    int repeat_count;  /* Number of words that the line represents */
+} word_run;
+
+/** The first address of the words of a source line (for the listing file) */
+typedef struct line_address {
+    int line_number;  /* Line number in the ".am" file */
+    int address;      /* The data counter before the line was encoded */
+} line_address;
+
+/** Structure to hold the code table or the data table.
+ * The words are kept in a dense array (4 bytes per word), and the rare lines that need more information are kept in sparse side tables.
+ * The address of a word is not stored: it is the address of the first word + its index (+ the extra words of the runs before it).
+ * All the arrays are allocated geometrically (the capacity is doubled when it is full), so adding a line costs O(1) amortized.
+ * A line is identified by its index, that never changes (a pointer to a line may change when lines are added).
+ * In stream mode the code words before 'first_index' were already written to 'spool' (the array keeps only the rest of the words),
+ * and the data lines are written to their own 'spool' whenever there are STREAM_FLUSH_WORDS of them. */
+typedef struct word_store {
+    int *words;                         /* The machine code of each line */
+    int lines;                          /* Number of lines in use (it is smaller than the number of words if .space/.fill runs were added) */
+    int capacity;                       /* Number of allocated lines */
+    fixup *fixups;                      /* The lines that are encoded in the second pass, by increasing index (code table only) */
+    int fixups_lines;
+    int fixups_capacity;
+    word_run *runs;                     /* The lines that represent more than one word, by increasing index (data table only) */
+    int runs_lines;
+    int runs_capacity;
+    line_address *line_addresses;       /* The directive lines that added words, by their order in the file (data table with --listing only) */
+    int line_addresses_lines;
+    int line_addresses_capacity;
+    int first_index;                    /* Index of the first word in 'words' (0 unless words were written to the spool) */
+    int first_pending_fixup;            /* Stream mode: no fixup before this one is waiting for its label (code table only) */
+    int resolved_fixups;                /* Single pass mode: number of resolved fixups in 'fixups' (they are removed by remove_resolved_fixups) */
+    FILE *spool;                        /* Stream mode: temporary file of the written words - object file lines (code), or data_spool_line records (data) - NULL otherwise */
+} word_store;
+
+/** Structure to hold all required data for a specific instruction line in order to convert and add it to the code table
+ * The first pass keeps one record per instruction line of the file (the instruction table) */
 typedef struct encoded_instruction {/* Values are in decimal base */
     int opcode;
     int source_addressing_mode;
@@ -27,26 +73,61 @@ typedef struct encoded_instruction {/* Values are in decimal base */
     int num_of_args;
     char *source_operand;
     char *destination_operand;
+    int source_immediate;       /* Value of the source operand (if it is in immediate addressing mode) */
+    int destination_immediate;  /* Value of the destination operand (if it is in immediate addressing mode) */
+    int address;                /* Address of the first word of the instruction (IC) */
+    int line_number;            /* Line number in the ".am" file */
+    int first_word_template;    /* The fields of the first word that depend only on the instruction (see 'first_word_template' in instruction_info) */
 } encoded_instruction;
 
-/** Structure to hold all allowed values for an instruction */
+/** Structure to hold all allowed values for an instruction (generated from INSTRUCTIONS_SPEC in isa_spec.h) */
 typedef struct instruction_info {
     char *name;
     int opcode;
     int funct;
-    int src_valid_addressing_modes[MAX_NUM_OF_VALID_ADDRESSING_MODES_FOR_PARAMETER];
-    int dest_valid_addressing_modes[MAX_NUM_OF_VALID_ADDRESSING_MODES_FOR_PARAMETER];
+    int src_valid_addressing_modes;   /* Bitmask of the valid addressing modes (IMMEDIATE_BIT | DIRECT_BIT | ...) */
+    int dest_valid_addressing_modes;  /* Bitmask of the valid addressing modes (IMMEDIATE_BIT | DIRECT_BIT | ...) */
     int num_of_args;
+    int first_word_template;          /* The first word without the operand fields (FIRST_WORD_TEMPLATE) - computed at compile time */
 } instruction_info;
 
-/** Structure to hold the label table */
+/** Structure to hold the label table (a line takes 16 bytes on 64-bit systems: the name pointer, the address and the flags) */
 typedef struct label_table {
-    int address;
     char *label;
-    char *type;            /* For code and data */
-    char *secondary_type;  /* For entries and externs */
+    int address;
+    unsigned char flags;   /* The attributes of the label: CODE_FLAG, DATA_FLAG, ENTRY_FLAG, EXTERN_FLAG, DEFINED_FLAG (combined with '|') */
 } label_table;
 
+/** A .entry directive of the file (it is applied to the label table in the second pass, when all the labels are defined) */
+typedef struct entry_request {
+    char *label;      /* The label name */
+    int line_number;  /* Line number in the ".am" file (for error messages in the second pass) */
+} entry_request;
+
+/** A cell of the hash index of the symbol table (8 bytes: the 32-bit hash and the line) */
+typedef struct symbol_hash_cell {
+    unsigned int hash;   /* The full hash of the label name (the names are compared only if their hashes are equal) */
+    int line;            /* The line of the label in the label table (EMPTY_HASH_CELL if the cell is empty) */
+} symbol_hash_cell;
+
+/** Structure to hold the symbol table: the label table and a hash index of the label names.
+ * The labels are kept in the order they were added (for a deterministic output), and the hash index
+ * (open addressing with linear probing) maps a label name to its line => insertion and lookup cost O(1) */
+typedef struct symbol_table {
+    label_table *labels;  /* The label table (by insertion order) */
+    int lines;            /* Number of lines in the label table */
+    int capacity;         /* Number of allocated lines in the label table */
+    symbol_hash_cell *hash_index;  /* Lines of the labels (EMPTY_HASH_CELL if empty), at the hash of their name */
+    int hash_size;        /* Size of the hash index (a power of 2, at least twice the number of labels) */
+    entry_request *entry_requests;  /* The .entry directives of the file (by their order in the file) */
+    int entry_requests_lines;
+    int entry_requests_capacity;
+    struct symbol_table *forward_references;  /* Single pass mode only (NULL otherwise): the labels that were referenced before their definition.
+                                               * The address of such a label is the index of the first fixup of its chain (or NO_FIXUP) */
+    char *name_pool;      /* Stream mode: the current block of the label names that outlive their instruction line (a block starts with a pointer to the previous block) */
+    int name_pool_used;   /* Number of bytes in use in the current block */
+} symbol_table;
+
 /** Structure to hold entries/externals table */
 typedef struct general_table {
     int address;
@@ -61,12 +142,13 @@ typedef struct general_table {
  *
  * Input:
  *   - file_name: Name of the assembly source file to process
+ *   - options: The options of the command line (single pass mode)
  *
  * Output:
  *   - Returns 0 if the first pass completed successfully
  *   - Returns an error code if errors were encountered
  */
-int first_pass_stage(char *file_name);
+int first_pass_stage(char *file_name, assembler_options *options);
 
 
 /**
@@ -76,38 +158,43 @@ int first_pass_stage(char *file_name);
  *
  * Input:
  *   - file: Pointer to the open assembly source file being processed
- *   - instruction_line: Pointer to the pointer of the instruction structure to store encoded instructions
+ *   - instructions: Pointer to the instruction table (one encoded instruction per instruction line)
+ *   - instructions_lines: Pointer to the count of lines in the instruction table
+ *   - instructions_capacity: Pointer to the number of allocated lines in the instruction table
  *   - code: Pointer to the code array where encoded instructions will be stored
  *   - data: Pointer to the data array where encoded directives will be stored
- *   - label_table: Pointer to the label table to store defined labels
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - IC: Pointer to the Instruction Counter, which will be updated as instructions are encoded
  *   - DC: Pointer to the Data Counter, which will be updated as directives are encoded
- *   - label_table_lines: Pointer to the count of lines in the label table
+ *   - options: Pointer to the command line options
  *
  * Output:
  *   - No return value
  */
-void encode_all_assembly_lines(FILE *file, encoded_instruction **instruction_line, code_data_array **code, code_data_array **data, label_table **label_table, int *IC, int *DC, int *label_table_lines);
+void encode_all_assembly_lines(FILE *file, encoded_instruction **instructions, int *instructions_lines, int *instructions_capacity, word_store *code, word_store *data, symbol_table *symbols, int *IC, int *DC, assembler_options *options);
 
 
 /**
  * Encodes an assembly instruction line into its binary representation.
- * This function identifies the instruction type, validates operands, and creates
- * the encoded representation for further processing.
+ * This function identifies the instruction type, validates operands, and adds
+ * the encoded representation to the instruction table for further processing.
+ * In stream mode the instruction table keeps only the current line: it is freed after the line is encoded.
  *
  * Input:
  *   - ptr: Pointer to the pointer of the current position in the line being processed
  *   - line: The complete line text being processed
- *   - instruction_line: Pointer to the pointer of the instruction structure to store encoded instruction
+ *   - instructions: Pointer to the instruction table where the encoded instruction will be stored
+ *   - instructions_lines: Pointer to the count of lines in the instruction table
+ *   - instructions_capacity: Pointer to the number of allocated lines in the instruction table
  *   - code: Pointer to the code array where the encoded instruction will be stored
- *   - label_table: Pointer to the label table for referencing labels
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - IC: Pointer to the Instruction Counter, which will be updated as words are added
- *   - label_table_lines: Pointer to the count of lines in the label table
+ *   - options: Pointer to the command line options
  *
  * Output:
  *   - No return value
  */
-void encode_instruction(char **ptr, char *line, encoded_instruction **instruction_line, code_data_array **code, label_table **label_table, int *IC, int *label_table_lines);
+void encode_instruction(char **ptr, char *line, encoded_instruction **instructions, int *instructions_lines, int *instructions_capacity, word_store *code, symbol_table *symbols, int *IC, assembler_options *options);
 
 
 /**
@@ -136,14 +223,14 @@ void create_encoded_instruction(char *instr_name, char *instr_source_operand, ch
  *   - ptr: Pointer to the pointer of the current position in the line being processed
  *   - line: The complete line text being processed
  *   - data: Pointer to the data array where the encoded directive will be stored
- *   - label_table: Pointer to the label table for adding labels defined with directives
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - DC: Pointer to the Data Counter, which will be updated as data words are added
- *   - label_table_lines: Pointer to the count of lines in the label table
+ *   - options: The command line options (the addresses of the lines are saved only for --listing)
  *
  * Output:
  *   - No return value
  */
-void encode_directive(char **ptr, char *line, code_data_array **data, label_table **label_table, int *DC, int *label_table_lines);
+void encode_directive(char **ptr, char *line, word_store *data, symbol_table *symbols, int *DC, assembler_options *options);
 
 
 #endif /* FIRST_PASS_H */
\ No newline at end of file
@@ -12,37 +12,64 @@
 #define BIG_INTEGER 1000                            /** Declared in order to check validity of line length */
 #define MAX_LINE_LENGTH 81                          /** 80 allowed chars +1 for \n */
 #define MAX_LABEL_LENGTH 31                         /** Maximum length of a label in the assembly language */
-#define OPCODE_NUM_OF_BITS 6                        /** Number of bits for the 'opcode' */
-#define SOURCE_ADDRESSING_MODE_NUM_OF_BITS 2        /** Number of bits for the 'source addressing mode' */
-#define SOURCE_REGISTER_NUM_OF_BITS 3               /** Number of bits for the 'source register' */
-#define DESTINATION_ADDRESSING_MODE_NUM_OF_BITS 2   /** Number of bits for the 'destination addressing mode' */
-#define DESTINATION_REGISTER_NUM_OF_BITS 3          /** Number of bits for the 'destination register' */
-#define FUNCT_NUM_OF_BITS 5                         /** Number of bits for the 'funct' */
-#define A_NUM_OF_BITS 1                             /** Number of bits for the 'A' */
-#define R_NUM_OF_BITS 1                             /** Number of bits for the 'R' */
-#define E_NUM_OF_BITS 1                             /** Number of bits for the 'E' */
-#define ADDITIONAL_WORD_LENGTH_IN_BITS 21           /** Number of bits in the main field in an additional word (in the code/data table) */
-#define NUM_OF_ERRORS 41                            /** Number of possible errors in the assembly language */
+#define NUM_OF_ERRORS 53                            /** Number of possible errors in the assembly language */
 #define WORD_SIZE 24                                /** The name "word" is defined as a memory cell */
-#define NUM_OF_INSTRUCTIONS 16                      /** Number of instructions in the assembly language */
-#define NUM_OF_DIRECTIVES 4                         /** Number of directives in the assembly language */
+#define NUM_OF_DIRECTIVES 8                         /** Number of directives in the assembly language */
 #define NUM_OF_REGISTERS 8                          /** Number of registers in the assembly language */
-#define MAX_NUM_OF_VALID_ADDRESSING_MODES_FOR_PARAMETER 3  /** Maximum number of valid addressing modes for a parameter */
-#define CODE_TYPE "code"                            /** Attribute name for the code table */
-#define DATA_TYPE "data"                            /** Attribute name for the data table */
-#define ENTRY_TYPE "entry"                          /** Attribute name for the entry table */
-#define EXTERN_TYPE "external"                      /** Attribute name for the external table */
-#define HEX_STR_SIZE 7                              /** 6 digits + '\0' */
+#define REGISTER_NAME_LENGTH 2                      /** Length of a register name (r0, ..., r7) */
+#define MIN_INSTRUCTION_NAME_LENGTH 3               /** Length of the shortest instruction name */
+#define EMPTY_HASH_CELL (-1)                        /** Marks an empty cell in a hash table */
+#define CODE_FLAG 0x01                              /** Attribute flag of a label of the code table */
+#define DATA_FLAG 0x02                              /** Attribute flag of a label of the data table */
+#define ENTRY_FLAG 0x04                             /** Attribute flag of an entry label */
+#define EXTERN_FLAG 0x08                            /** Attribute flag of an external label */
+#define DEFINED_FLAG 0x10                           /** Attribute flag of a label that is defined in the file (code or data) */
+#define MAX_DIRECTIVE_NUMBERS_PER_CALL (MAX_LINE_LENGTH / 2)  /** Size of a batch of .data numbers (enough for a whole line: a number and a comma take at least 2 chars) */
+#define ADDRESS_DIGITS 7                            /** Number of decimal digits of an address in the output files (with leading zeros) */
+#define HEX_DIGITS_PER_WORD 6                       /** Number of hexadecimal digits of a word in the object file */
+#define BITS_PER_NIBBLE 4                           /** Number of bits of a hexadecimal digit */
+#define NIBBLE_MASK 0xF                             /** Mask of the bits of a hexadecimal digit */
+#define OBJECT_LINE_LENGTH 15                       /** Length of a line of the object file: address, ' ', machine code and '\n' */
+#define OBJECT_BUFFER_SIZE 65536                    /** Size of the buffer of the object file (it is written with a single fwrite when it is full) */
 #define MAX_NUM_OF_WORDS 2097152                    /** 2^21 */
+#define BITS_PER_BYTE 8                             /** Number of bits in a byte of a binary file (.incbin) */
+#define BYTES_PER_WORD 3                            /** Number of bytes in a packed word (.incbinw) */
+#define INITIAL_WORD_STORE_CAPACITY 64               /** Number of lines that are allocated for a code/data table (or its side tables) when its first line is added */
+#define INITIAL_SYMBOL_HASH_SIZE 64                 /** Minimal size of the hash index of the symbol table (a power of 2) */
+#define ESTIMATED_LINE_LENGTH 12                    /** Average length of a line in the ".am" file (for the estimation of the number of lines) */
+#define EMPTY_WORD_STORE {NULL, 0, 0, NULL, 0, 0, NULL, 0, 0, NULL, 0, 0, 0, 0, 0, NULL}  /** Initializer of an empty code/data table */
+#define INCBIN_BUFFER_SIZE 4096                     /** Size of the buffer that is used for reading binary files (.incbin) */
+#define NO_FIXUP (-1)                               /** End of a chain of fixups (single pass mode) */
+#define RESOLVED_FIXUP (-1)                         /** Kind of a fixup that was already resolved in the first pass (single pass mode) */
+#define SINGLE_PASS_OPTION "--single-pass"          /** Command line option of the single pass mode */
+#define FORMAT_OPTION "--format="                   /** Command line option of the format of the object file (followed by "text" or "bin") */
+#define LISTING_OPTION "--listing"                  /** Command line option of the listing file (".lst") */
+#define STREAM_OPTION "--stream"                    /** Command line option of the stream mode (less memory, see README.md) */
+#define STREAM_FLUSH_WORDS 4096                     /** Minimal number of final code words/data lines that are written to their spool at once (stream mode) */
+#define NAME_POOL_BLOCK_SIZE 65536                  /** Size of a block of the pool of label names (stream mode) */
+#define LISTING_FIELDS_SIZE 96                      /** Size of the buffer of the fields of a word in the listing file */
+#define NUM_OF_OUTPUT_FILES 3                       /** The object file, the entries file and the externals file */
+#define OBJECT_OUTPUT 0                             /** Index of the object file in the output files */
+#define ENTRIES_OUTPUT 1                            /** Index of the entries file in the output files */
+#define EXTERNALS_OUTPUT 2                          /** Index of the externals file in the output files */
+#define TEMPORARY_FILE_EXTENSION ".tmp"             /** Added to the name of an output file while it is written */
+#define TEXT_OBJECT_FORMAT 0                        /** The object file is a text file (".ob") - the default */
+#define BINARY_OBJECT_FORMAT 1                      /** The object file is a binary file (".obj", see binary_object.h) */
 #define GARBAGE_VALUE 2389325                       /** A garbage value for return purposes */
 #define ASCII_MIN 0                                 /** Minimum ASCII value */
 #define ASCII_MAX 127                               /** Maximum ASCII value */
 #define INITIAL_IC_VALUE 100                        /** Initial value for the Instruction Counter */
 #define INITIAL_DC_VALUE 0                          /** Initial value for the Data Counter */
-#define END_OF_ARRAY 4329419                        /** A garbage value to mark the end of an array (like '\0' does to a string) */
-#define BINARY_BASE 2                               /** Base for binary numbers */
 #define DECIMAL_BASE 10                             /** Base for decimal numbers */
 
+/** The options of the command line (they apply to all the files) */
+typedef struct assembler_options {
+    int single_pass;    /* Resolve the label operands during the first pass (see resolve_new_fixups and backpatch_label in second_pass.c) */
+    int object_format;  /* TEXT_OBJECT_FORMAT or BINARY_OBJECT_FORMAT */
+    int listing;        /* Create a listing file (".lst", see listing.c) */
+    int stream;         /* Stream mode: single pass, and the final code words are written during the first pass (see flush_resolved_code_words) */
+} assembler_options;
+
 /* Error stages for print_error function */
 #define AS_FILE_STAGE 0
 #define AM_FILE_STAGE 1
@@ -53,6 +80,21 @@
 #define DIRECT_ADDRESSING_MODE 1
 #define RELATIVE_ADDRESSING_MODE 2
 #define DIRECT_REGISTER_ADDRESSING_MODE 3
+#define NUM_OF_ADDRESSING_MODES 4
+
+/* Character class bits (a character may belong to several classes, see CHAR_CLASSES in auxiliary_functions.c) */
+#define WHITESPACE_CHAR_CLASS 0x01                  /** ' ', '\t', '\n', '\v', '\f', '\r' */
+#define COMMA_CHAR_CLASS 0x02                       /** ',' */
+#define COLON_CHAR_CLASS 0x04                       /** ':' */
+#define QUOTE_CHAR_CLASS 0x08                       /** '"' */
+#define HASH_CHAR_CLASS 0x10                        /** '#' */
+#define AMPERSAND_CHAR_CLASS 0x20                   /** '&' */
+#define SEMICOLON_CHAR_CLASS 0x40                   /** ';' */
+#define LABEL_CHAR_CLASS 0x80                       /** Alphabetic characters and digits */
+#define NUM_OF_CHARS 256                            /** Number of possible values of a char */
+
+/* The instruction set (fields of a word, instructions, their opcodes, functs and valid addressing modes) */
+#include "isa_spec.h"
 
 
 #endif /* GENERAL_HEADER_H */
\ No newline at end of file
@@ -0,0 +1,8 @@
+MAIN: 	lea ZEROS, r1
+ 	mov FILL, r2
+ 	cmp #5, TABLE
+END: 	stop
+ZEROS: 	.space 3
+FILL: 	.fill 2, -1
+TABLE: 	.fill 4, 7
+ 	.data 12
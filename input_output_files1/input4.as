@@ -0,0 +1,8 @@
+MAIN: 	lea BYTES, r1
+ 	mov WORDS, r2
+ 	stop
+BYTES: 	.incbin "input4.bin"
+ 	.incbin "input4.bin", 3, 2
+WORDS: 	.incbinw "input4.bin"
+ 	.incbinw "input4.bin", 1, 3
+ 	.data 5
@@ -0,0 +1,6 @@
+MAIN: 	stop
+OK: 	.space 2097000
+BIG: 	.space 200
+ 	.fill 2097152, 1
+ 	.fill -2, 1
+ 	.space 3, 4
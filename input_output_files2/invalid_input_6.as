@@ -0,0 +1,3 @@
+MAIN: 	stop
+.entry MAIN
+.entry NOPE
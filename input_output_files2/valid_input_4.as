@@ -12,7 +12,6 @@ sub r1, r4
     bne END
     mcroend
 
-    .entry GGG
 prn #-5
 bne LOOP
 
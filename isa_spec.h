@@ -0,0 +1,126 @@
+#ifndef ISA_SPEC_H
+#define ISA_SPEC_H
+
+
+/* This file is the single definition of the instruction set of the assembly language.
+ * Everything that depends on the instruction set (the fields of a word, the INSTRUCTIONS table,
+ * the shifts and masks of the encoder and the instruction lookup) is generated from the lists below
+ * by defining the macro X before expanding a list ("X-macros").
+ * Changing the instruction set is done only in this file.
+ */
+
+
+/** The fields of the first word of an instruction, from the least significant bit to the most significant bit.
+ * X(FIELD, NUM_OF_BITS) */
+#define FIRST_WORD_FIELDS \
+    X(E, 1) \
+    X(R, 1) \
+    X(A, 1) \
+    X(FUNCT, 5) \
+    X(DESTINATION_REGISTER, 3) \
+    X(DESTINATION_ADDRESSING_MODE, 2) \
+    X(SOURCE_REGISTER, 3) \
+    X(SOURCE_ADDRESSING_MODE, 2) \
+    X(OPCODE, 6)
+
+/** Bits of the valid addressing modes of an operand (combined with '|') */
+#define NO_OPERAND 0
+#define IMMEDIATE_BIT (1 << IMMEDIATE_ADDRESSING_MODE)
+#define DIRECT_BIT (1 << DIRECT_ADDRESSING_MODE)
+#define RELATIVE_BIT (1 << RELATIVE_ADDRESSING_MODE)
+#define REGISTER_BIT (1 << DIRECT_REGISTER_ADDRESSING_MODE)
+
+/** The instructions of the assembly language.
+ * X(ID, NAME, OPCODE, FUNCT, VALID_SOURCE_ADDRESSING_MODES, VALID_DESTINATION_ADDRESSING_MODES, NUM_OF_ARGS) */
+#define INSTRUCTIONS_SPEC \
+    X(MOV,  "mov",  0,  0, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, DIRECT_BIT | REGISTER_BIT, 2) \
+    X(CMP,  "cmp",  1,  0, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, 2) \
+    X(ADD,  "add",  2,  1, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, DIRECT_BIT | REGISTER_BIT, 2) \
+    X(SUB,  "sub",  2,  2, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, DIRECT_BIT | REGISTER_BIT, 2) \
+    X(LEA,  "lea",  4,  0, DIRECT_BIT, DIRECT_BIT | REGISTER_BIT, 2) \
+    X(CLR,  "clr",  5,  1, NO_OPERAND, DIRECT_BIT | REGISTER_BIT, 1) \
+    X(NOT,  "not",  5,  2, NO_OPERAND, DIRECT_BIT | REGISTER_BIT, 1) \
+    X(INC,  "inc",  5,  3, NO_OPERAND, DIRECT_BIT | REGISTER_BIT, 1) \
+    X(DEC,  "dec",  5,  4, NO_OPERAND, DIRECT_BIT | REGISTER_BIT, 1) \
+    X(JMP,  "jmp",  9,  1, NO_OPERAND, DIRECT_BIT | RELATIVE_BIT, 1) \
+    X(BNE,  "bne",  9,  2, NO_OPERAND, DIRECT_BIT | RELATIVE_BIT, 1) \
+    X(JSR,  "jsr",  9,  3, NO_OPERAND, DIRECT_BIT | RELATIVE_BIT, 1) \
+    X(RED,  "red",  12, 0, NO_OPERAND, DIRECT_BIT | REGISTER_BIT, 1) \
+    X(PRN,  "prn",  13, 0, NO_OPERAND, IMMEDIATE_BIT | DIRECT_BIT | REGISTER_BIT, 1) \
+    X(RTS,  "rts",  14, 0, NO_OPERAND, NO_OPERAND, 0) \
+    X(STOP, "stop", 15, 0, NO_OPERAND, NO_OPERAND, 0)
+
+
+/* ---------------- Everything below is generated from the lists above ---------------- */
+
+/** Number of bits of each field (E_NUM_OF_BITS, R_NUM_OF_BITS, ..., OPCODE_NUM_OF_BITS) */
+enum first_word_field_sizes {
+#define X(field, num_of_bits) field##_NUM_OF_BITS = (num_of_bits),
+    FIRST_WORD_FIELDS
+#undef X
+    FIRST_WORD_FIELD_SIZES_END
+};
+
+/** Position of the least significant bit of each field (E_SHIFT, R_SHIFT, ..., OPCODE_SHIFT).
+ * Each field starts right after the last bit ('field'_LAST_BIT) of the previous field. */
+enum first_word_field_shifts {
+#define X(field, num_of_bits) field##_SHIFT, field##_LAST_BIT = field##_SHIFT + (num_of_bits) - 1,
+    FIRST_WORD_FIELDS
+#undef X
+    FIRST_WORD_NUM_OF_BITS  /* Is equal to the last bit of the last field + 1 */
+};
+
+/** The value of an additional word (immediate number, address or jumping distance) starts right after the 'A,R,E' fields */
+#define OPERAND_VALUE_SHIFT (A_SHIFT + A_NUM_OF_BITS)
+#define ADDITIONAL_WORD_LENGTH_IN_BITS (WORD_SIZE - OPERAND_VALUE_SHIFT)   /** Number of bits in the main field in an additional word */
+
+/** Mask of 'num_of_bits' ones */
+#define BITS_MASK(num_of_bits) ((1L << (num_of_bits)) - 1)
+/** Places 'value' in the field 'field' of a word (the value is cut to the size of the field) */
+#define ENCODE_FIELD(field, value) ((int)(((long)(value) & BITS_MASK(field##_NUM_OF_BITS)) << field##_SHIFT))
+/** Places 'value' in the value field of an additional word (two's complement is used for negative values) */
+#define ENCODE_OPERAND_VALUE(value) ((int)(((long)(value) & BITS_MASK(ADDITIONAL_WORD_LENGTH_IN_BITS)) << OPERAND_VALUE_SHIFT))
+/** Gets the value of the field 'field' of a word */
+#define DECODE_FIELD(field, word) ((int)(((long)(word) >> field##_SHIFT) & BITS_MASK(field##_NUM_OF_BITS)))
+/** The part of the first word that depends only on the instruction: opcode, funct and A,R,E = 1,0,0 (a constant expression) */
+#define FIRST_WORD_TEMPLATE(opcode, funct) (ENCODE_FIELD(OPCODE, opcode) | ENCODE_FIELD(FUNCT, funct) | ENCODE_FIELD(A, 1))
+
+/** Identifiers of the instructions (MOV_INSTRUCTION, ..., STOP_INSTRUCTION) - equal to their index in INSTRUCTIONS */
+enum instruction_ids {
+#define X(id, name, opcode, funct, src_modes, dest_modes, num_of_args) id##_INSTRUCTION,
+    INSTRUCTIONS_SPEC
+#undef X
+    NUM_OF_INSTRUCTIONS
+};
+
+/** Size of the hash table of the instruction names (a power of 2 that is bigger than NUM_OF_INSTRUCTIONS) */
+#define INSTRUCTIONS_HASH_SIZE 32
+/** Hash of an instruction name (of at least 3 characters). The names in INSTRUCTIONS_SPEC have no collisions (a lookup is a single probe);
+ * it is not a perfect hash for other names - a collision is resolved by linear probing (see build_instructions_hash_table) */
+#define INSTRUCTION_NAME_HASH(name) ((3 * (unsigned char)(name)[0] + 18 * (unsigned char)(name)[1] + (unsigned char)(name)[2]) & (INSTRUCTIONS_HASH_SIZE - 1))
+
+
+/* Compile time checks of the layout (an array with a negative size fails the compilation) */
+#define COMPILE_TIME_CHECK(condition, name) typedef char name[(condition) ? 1 : -1]
+
+COMPILE_TIME_CHECK(FIRST_WORD_NUM_OF_BITS == WORD_SIZE, first_word_fields_fill_a_word);
+COMPILE_TIME_CHECK(A_NUM_OF_BITS == 1 && R_NUM_OF_BITS == 1 && E_NUM_OF_BITS == 1, a_r_e_fields_are_single_bits);
+COMPILE_TIME_CHECK(ADDITIONAL_WORD_LENGTH_IN_BITS == 21, additional_word_value_is_21_bits);
+COMPILE_TIME_CHECK((1 << SOURCE_REGISTER_NUM_OF_BITS) >= NUM_OF_REGISTERS, registers_fit_in_source_register_field);
+COMPILE_TIME_CHECK((1 << DESTINATION_REGISTER_NUM_OF_BITS) >= NUM_OF_REGISTERS, registers_fit_in_destination_register_field);
+COMPILE_TIME_CHECK((1 << SOURCE_ADDRESSING_MODE_NUM_OF_BITS) > DIRECT_REGISTER_ADDRESSING_MODE, addressing_modes_fit_in_source_field);
+COMPILE_TIME_CHECK((1 << DESTINATION_ADDRESSING_MODE_NUM_OF_BITS) > DIRECT_REGISTER_ADDRESSING_MODE, addressing_modes_fit_in_destination_field);
+COMPILE_TIME_CHECK(INSTRUCTIONS_HASH_SIZE >= NUM_OF_INSTRUCTIONS, instructions_fit_in_hash_table);
+COMPILE_TIME_CHECK(BYTES_PER_WORD * BITS_PER_BYTE == WORD_SIZE, packed_bytes_fill_a_word);
+COMPILE_TIME_CHECK(HEX_DIGITS_PER_WORD * BITS_PER_NIBBLE == WORD_SIZE, hex_digits_fill_a_word);
+COMPILE_TIME_CHECK(OBJECT_LINE_LENGTH == ADDRESS_DIGITS + 1 + HEX_DIGITS_PER_WORD + 1, object_line_is_address_and_hex_digits);
+COMPILE_TIME_CHECK(NUM_OF_ADDRESSING_MODES == 4 && NUM_OF_REGISTERS == 8, operand_field_tables_match_the_number_of_modes_and_registers);
+
+/* Check that the opcode and funct of every instruction fit in their fields */
+#define X(id, name, opcode, funct, src_modes, dest_modes, num_of_args) \
+    COMPILE_TIME_CHECK((opcode) <= BITS_MASK(OPCODE_NUM_OF_BITS) && (funct) <= BITS_MASK(FUNCT_NUM_OF_BITS), id##_opcode_and_funct_fit_in_their_fields);
+INSTRUCTIONS_SPEC
+#undef X
+
+
+#endif /* ISA_SPEC_H */
\ No newline at end of file
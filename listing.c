@@ -0,0 +1,158 @@
+#include "listing.h"
+#include "general_header.h"
+#include "auxiliary_functions.h"
+#include "table.h"
+#include "errors.h"
+
+
+/* This class contains the functions of the listing file (--listing).
+ * Each line of the listing file is: the line number, the address, the word in hexadecimal, its fields and the source line.
+ * An instruction or a directive with more than one word continues in the next lines (without the line number and the source).
+ */
+
+
+void create_listing_file(char *file_name, FILE *am_file, encoded_instruction *instructions, int instructions_lines, word_store *code, word_store *data, int ICF, int DCF)
+{
+    char line[MAX_LINE_LENGTH];      /* Buffer to store each line read from the file */
+    char *listing_file_name;
+    FILE *listing_file;
+    int line_number = 0;
+    int instruction = 0;             /* The next line of the instruction table */
+    int data_directive = 0;          /* The next line address of the data table */
+    int data_line = 0, run = 0;      /* The next line and the next run of the data table */
+    int next_address;                /* The data counter after the current directive */
+
+    listing_file_name = get_file_name(2, file_name, ".lst");
+    listing_file = safe_fopen(listing_file_name, "w");
+    free(listing_file_name);
+    if (listing_file == NULL)
+        return;
+    /* The listing file is written in large blocks */
+    setvbuf(listing_file, NULL, _IOFBF, OBJECT_BUFFER_SIZE);
+
+    fprintf(listing_file, "%5s  %-7s  %-6s  %-48s  %s\n", "Line", "Address", "Word", "Fields", "Source");
+    rewind(am_file);
+    while (fgets(line, sizeof(line), am_file))
+    {/* Read line by line (the tables are by the order of the lines) */
+        line_number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        fprintf(listing_file, "%5d  ", line_number);
+
+        if (instruction < instructions_lines && instructions[instruction].line_number == line_number)
+        {/* Instruction line */
+            list_instruction(listing_file, line, &instructions[instruction++], code);
+        }
+        else if (data_directive < data->line_addresses_lines && data->line_addresses[data_directive].line_number == line_number)
+        {/* Directive line that added data words (they are after the code words => their address is ICF + DC) */
+            next_address = (data_directive + 1 < data->line_addresses_lines) ? data->line_addresses[data_directive + 1].address : DCF;
+            list_data(listing_file, line, ICF + data->line_addresses[data_directive].address, next_address - data->line_addresses[data_directive].address, data, &data_line, &run);
+            data_directive++;
+        }
+        else
+        {/* A line without words (empty line, comment, .entry or .extern) */
+            fprintf(listing_file, "%-7s  %-6s  %-48s  %s\n", "", "", "", line);
+        }
+    }
+
+    fclose(listing_file);
+}
+
+void list_instruction(FILE *file, char *source, encoded_instruction *instruction, word_store *code)
+{
+    int i, num_of_operand_words = 0;
+    int index = instruction->address - INITIAL_IC_VALUE;  /* Index of the first word in the code table */
+    int word = code->words[index];
+    int modes[2];                    /* The addressing modes of the operands that have a word (source first) */
+    char *operands[2];
+    char fields[LISTING_FIELDS_SIZE];
+
+    /* The first word */
+    describe_first_word(fields, word);
+    fprintf(file, "%.7d  %06x  %-48s  %s\n", instruction->address, (unsigned)(word & BITS_MASK(WORD_SIZE)), fields, source);
+
+    /* The operands that have an additional word (a register operand is encoded in the first word) */
+    if (instruction->num_of_args == 2 && instruction->source_addressing_mode != DIRECT_REGISTER_ADDRESSING_MODE)
+    {
+        modes[num_of_operand_words] = instruction->source_addressing_mode;
+        operands[num_of_operand_words++] = instruction->source_operand;
+    }
+    if (instruction->num_of_args >= 1 && instruction->destination_addressing_mode != DIRECT_REGISTER_ADDRESSING_MODE)
+    {
+        modes[num_of_operand_words] = instruction->destination_addressing_mode;
+        operands[num_of_operand_words++] = instruction->destination_operand;
+    }
+
+    for (i = 0; i < num_of_operand_words; i++)
+    {/* The additional words follow the first word */
+        word = code->words[index + 1 + i];
+        describe_operand_word(fields, modes[i], operands[i], word, instruction->address);
+        fprintf(file, "%5s  %.7d  %06x  %s\n", "", instruction->address + 1 + i, (unsigned)(word & BITS_MASK(WORD_SIZE)), fields);
+    }
+}
+
+void describe_first_word(char *fields, int word)
+{
+    sprintf(fields, "opcode %2d funct %2d src %d r%d dst %d r%d ARE %d%d%d", DECODE_FIELD(OPCODE, word), DECODE_FIELD(FUNCT, word),
+            DECODE_FIELD(SOURCE_ADDRESSING_MODE, word), DECODE_FIELD(SOURCE_REGISTER, word),
+            DECODE_FIELD(DESTINATION_ADDRESSING_MODE, word), DECODE_FIELD(DESTINATION_REGISTER, word),
+            DECODE_FIELD(A, word), DECODE_FIELD(R, word), DECODE_FIELD(E, word));
+}
+
+void describe_operand_word(char *fields, int addressing_mode, char *operand, int word, int instruction_address)
+{
+    int value = decode_signed_value((long)word >> OPERAND_VALUE_SHIFT, ADDITIONAL_WORD_LENGTH_IN_BITS);
+    int ARE = word & BITS_MASK(OPERAND_VALUE_SHIFT);
+
+    if (addressing_mode == IMMEDIATE_ADDRESSING_MODE)
+    {
+        sprintf(fields, "immediate %d ARE %d%d%d", value, DECODE_FIELD(A, ARE), DECODE_FIELD(R, ARE), DECODE_FIELD(E, ARE));
+        return;
+    }
+
+    if (DECODE_FIELD(E, ARE))
+        sprintf(fields, "%.*s = external ARE %d%d%d", MAX_LABEL_LENGTH, operand, DECODE_FIELD(A, ARE), DECODE_FIELD(R, ARE), DECODE_FIELD(E, ARE));
+    else if (addressing_mode == DIRECT_ADDRESSING_MODE)
+        sprintf(fields, "%.*s = %.7d ARE %d%d%d", MAX_LABEL_LENGTH, operand, value, DECODE_FIELD(A, ARE), DECODE_FIELD(R, ARE), DECODE_FIELD(E, ARE));
+    else
+        /* The operand contains the '&' character */
+        sprintf(fields, "%.*s = %.7d distance %d ARE %d%d%d", MAX_LABEL_LENGTH + 1, operand, instruction_address + value, value, DECODE_FIELD(A, ARE), DECODE_FIELD(R, ARE), DECODE_FIELD(E, ARE));
+}
+
+void list_data(FILE *file, char *source, int address, int num_of_words, word_store *data, int *data_line, int *run)
+{
+    int word, value, repeat_count, first = 1;
+    char fields[LISTING_FIELDS_SIZE];
+
+    while (num_of_words > 0)
+    {/* Go over the lines of the directive in the data table */
+        word = data->words[*data_line];
+        value = decode_signed_value(word, WORD_SIZE);
+        repeat_count = (*run < data->runs_lines && data->runs[*run].index == *data_line) ? data->runs[(*run)++].repeat_count : 1;
+        (*data_line)++;
+
+        if (repeat_count > 1)
+            sprintf(fields, "value %d x %d", value, repeat_count);
+        else if (value >= ' ' && value <= '~')
+            /* Printable character (of .string, or a number that is equal to one) */
+            sprintf(fields, "value %d '%c'", value, value);
+        else
+            sprintf(fields, "value %d", value);
+
+        if (first)
+            fprintf(file, "%.7d  %06x  %-48s  %s\n", address, (unsigned)(word & BITS_MASK(WORD_SIZE)), fields, source);
+        else
+            fprintf(file, "%5s  %.7d  %06x  %s\n", "", address, (unsigned)(word & BITS_MASK(WORD_SIZE)), fields);
+        first = 0;
+        address += repeat_count;
+        num_of_words -= repeat_count;
+    }
+}
+
+int decode_signed_value(long value, int num_of_bits)
+{
+    value &= BITS_MASK(num_of_bits);
+    if (value & (1L << (num_of_bits - 1)))
+        /* The sign bit is on => the value is negative */
+        value -= 1L << num_of_bits;
+    return (int)value;
+}
\ No newline at end of file
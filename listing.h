@@ -0,0 +1,106 @@
+#ifndef LISTING_H
+#define LISTING_H
+
+
+#include "first_pass.h"
+
+/**
+ * Creates the listing file (".lst"): every line of the ".am" file with the addresses of its words, the words in hexadecimal,
+ * their fields and the values of their label operands.
+ * It is a single pass over the lines of the file, together with the instruction table and the line addresses of the data table
+ * (both are by the order of the lines).
+ *
+ * Input:
+ *   - file_name: Name of the source file being assembled
+ *   - am_file: Pointer to the ".am" file
+ *   - instructions: The instruction table
+ *   - instructions_lines: Number of lines in the instruction table
+ *   - code: Pointer to the code table (after the second pass)
+ *   - data: Pointer to the data table
+ *   - ICF: Final instruction counter value from first pass
+ *   - DCF: Final data counter value from first pass
+ *
+ * Output:
+ *   - No return value
+ */
+void create_listing_file(char *file_name, FILE *am_file, encoded_instruction *instructions, int instructions_lines, word_store *code, word_store *data, int ICF, int DCF);
+
+
+/**
+ * Writes the lines of an instruction to the listing file: the first word with its fields, and a line for each additional word.
+ *
+ * Input:
+ *   - file: Pointer to the listing file
+ *   - source: The source line (without '\n')
+ *   - instruction: Pointer to the line of the instruction in the instruction table
+ *   - code: Pointer to the code table
+ *
+ * Output:
+ *   - No return value
+ */
+void list_instruction(FILE *file, char *source, encoded_instruction *instruction, word_store *code);
+
+
+/**
+ * Describes the fields of the first word of an instruction (opcode, funct, addressing modes, registers and A,R,E).
+ *
+ * Input:
+ *   - fields: Buffer of LISTING_FIELDS_SIZE characters for the description
+ *   - word: The machine code of the word
+ *
+ * Output:
+ *   - No return value
+ */
+void describe_first_word(char *fields, int word);
+
+
+/**
+ * Describes an additional word of an instruction (an immediate number, or the resolved value of a label operand).
+ * The value of a label is taken from the word itself (E = 1 for an external label, and the address of a relative operand is
+ * the address of the instruction + the distance), so the symbol table is not searched.
+ *
+ * Input:
+ *   - fields: Buffer of LISTING_FIELDS_SIZE characters for the description
+ *   - addressing_mode: The addressing mode of the operand
+ *   - operand: The operand
+ *   - word: The machine code of the word
+ *   - instruction_address: The address of the first word of the instruction
+ *
+ * Output:
+ *   - No return value
+ */
+void describe_operand_word(char *fields, int addressing_mode, char *operand, int word, int instruction_address);
+
+
+/**
+ * Writes the lines of a directive to the listing file: a line for each data word (a .space/.fill run is a single line).
+ *
+ * Input:
+ *   - file: Pointer to the listing file
+ *   - source: The source line (without '\n')
+ *   - address: The address of the first word of the directive
+ *   - num_of_words: Number of words of the directive
+ *   - data: Pointer to the data table
+ *   - data_line: Pointer to the index of the first line of the directive in the data table (it is advanced to the next directive)
+ *   - run: Pointer to the index of the next run of the data table (it is advanced to the next directive)
+ *
+ * Output:
+ *   - No return value
+ */
+void list_data(FILE *file, char *source, int address, int num_of_words, word_store *data, int *data_line, int *run);
+
+
+/**
+ * Gets a signed value that is stored in two's complement in a number of bits.
+ *
+ * Input:
+ *   - value: The bits of the value
+ *   - num_of_bits: Number of bits of the value
+ *
+ * Output:
+ *   - Returns the signed value
+ */
+int decode_signed_value(long value, int num_of_bits);
+
+
+#endif /* LISTING_H */
\ No newline at end of file
@@ -9,55 +9,85 @@
 
 /** A table that contains the instruction name, opcode, funct, valid addressing modes for source and destination operands, and the number of arguments for each instruction.
  * Each instruction is represented by a structure of type 'instruction_info'.
- * END_OF_ARRAY is used to mark the end of an array. */
+ * The table is generated from INSTRUCTIONS_SPEC (isa_spec.h). */
 instruction_info INSTRUCTIONS[NUM_OF_INSTRUCTIONS] = {
-    {"mov", 0, 0, {0,1,3}, {1,3, END_OF_ARRAY}, 2},
-    {"cmp", 1, 0, {0,1,3}, {0,1,3}, 2},
-    {"add", 2, 1, {0,1,3}, {1,3, END_OF_ARRAY}, 2},
-    {"sub", 2, 2, {0,1,3}, {1,3, END_OF_ARRAY}, 2},
-    {"lea", 4, 0, {1, END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 2},
-    {"clr", 5, 1, {END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 1},
-    {"not", 5, 2, {END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 1},
-    {"inc", 5, 3, {END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 1},
-    {"dec", 5, 4, {END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 1},
-    {"jmp", 9, 1, {END_OF_ARRAY}, {1,2, END_OF_ARRAY}, 1},
-    {"bne", 9, 2, {END_OF_ARRAY}, {1,2, END_OF_ARRAY}, 1},
-    {"jsr", 9, 3, {END_OF_ARRAY}, {1,2, END_OF_ARRAY}, 1},
-    {"red", 12, 0, {END_OF_ARRAY}, {1,3, END_OF_ARRAY}, 1},
-    {"prn", 13, 0, {END_OF_ARRAY}, {0,1,3}, 1},
-    {"rts", 14, 0, {END_OF_ARRAY}, {END_OF_ARRAY}, 0},
-    {"stop", 15, 0, {END_OF_ARRAY}, {END_OF_ARRAY}, 0}
+#define X(id, name, opcode, funct, src_modes, dest_modes, num_of_args) {name, opcode, funct, src_modes, dest_modes, num_of_args, FIRST_WORD_TEMPLATE(opcode, funct)},
+    INSTRUCTIONS_SPEC
+#undef X
 };
 
+/** A hash table of the instruction names: maps INSTRUCTION_NAME_HASH of a name to its index in INSTRUCTIONS (EMPTY_HASH_CELL if empty).
+ * It is built on the first lookup (see 'find_instruction'). */
+int INSTRUCTIONS_HASH_TABLE[INSTRUCTIONS_HASH_SIZE];
+/** Indicates if INSTRUCTIONS_HASH_TABLE was built */
+int instructions_hash_table_is_built = 0;
+
 /** A table that contains the directive names */
-char* DIRECTIVES[NUM_OF_DIRECTIVES] = {".data", ".string", ".entry", ".extern"};
+char* DIRECTIVES[NUM_OF_DIRECTIVES] = {".data", ".string", ".space", ".fill", ".incbin", ".incbinw", ".entry", ".extern"};
 
 /** A table that contains the register names */
 char* REGISTERS[NUM_OF_REGISTERS] = {"r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7"};
 
 
-char *get_instruction_name(char **ptr)
+void build_instructions_hash_table(void)
 {
-    int i, instr_name_length;
+    int i, cell;
+
+    /* Mark all cells as empty */
+    for (i = 0; i < INSTRUCTIONS_HASH_SIZE; i++)
+        INSTRUCTIONS_HASH_TABLE[i] = EMPTY_HASH_CELL;
 
-    /* Search for the instruction name in the INSTRUCTIONS table */
     for (i = 0; i < NUM_OF_INSTRUCTIONS; i++)
-    {
-        instr_name_length = strlen(INSTRUCTIONS[i].name);
-        if (strncmp(*ptr, INSTRUCTIONS[i].name, instr_name_length) == 0)
-        {/* Our pointer *starts* with a certain instruction name */
-            if (isspace(*(*ptr + instr_name_length)) || *(*ptr + instr_name_length) == '\0')
-            {/* If it *ends* right after that - it is a valid instruction name */
-                /* Update pointer location and return instruction name */
-                *ptr += instr_name_length;
-                return INSTRUCTIONS[i].name;
-            }
-        }
+    {/* Insert the index of each instruction into the cell of its hash */
+        cell = INSTRUCTION_NAME_HASH(INSTRUCTIONS[i].name);
+        while (INSTRUCTIONS_HASH_TABLE[cell] != EMPTY_HASH_CELL)
+            /* The hash has no collisions for the current instruction set, but keep the table valid if the set is changed */
+            cell = (cell + 1) & (INSTRUCTIONS_HASH_SIZE - 1);
+        INSTRUCTIONS_HASH_TABLE[cell] = i;
     }
-    /* No valid instruction name has been found */
+    instructions_hash_table_is_built = 1;
+}
+
+instruction_info *find_instruction(char *name, int name_length)
+{
+    int cell;
+    instruction_info *instruction;
+
+    if (!instructions_hash_table_is_built)
+        build_instructions_hash_table();
+
+    if (name_length < MIN_INSTRUCTION_NAME_LENGTH)
+        /* Too short to be an instruction name (and to be hashed) */
+        return NULL;
+
+    for (cell = INSTRUCTION_NAME_HASH(name); INSTRUCTIONS_HASH_TABLE[cell] != EMPTY_HASH_CELL; cell = (cell + 1) & (INSTRUCTIONS_HASH_SIZE - 1))
+    {/* Compare the name with the instruction in the cell of its hash */
+        instruction = &INSTRUCTIONS[INSTRUCTIONS_HASH_TABLE[cell]];
+        if (strncmp(instruction->name, name, name_length) == 0 && instruction->name[name_length] == '\0')
+            return instruction;
+    }
+    /* No instruction with this name */
     return NULL;
 }
 
+char *get_instruction_name(char **ptr)
+{
+    instruction_info *instruction;
+    int instr_name_length;
+
+    /* The instruction name ends with a whitespace or at the end of the line */
+    instr_name_length = find_char_of_class(*ptr, WHITESPACE_CHAR_CLASS) - *ptr;
+
+    instruction = find_instruction(*ptr, instr_name_length);
+    if (instruction == NULL)
+        /* No valid instruction name has been found */
+        return NULL;
+
+    /* Update pointer location and return instruction name */
+    *ptr += instr_name_length;
+    return instruction->name;
+}
+
 char *get_instruction_operand(char **ptr, int num_of_commas_expected)
 {
     char *instr_operand;
@@ -90,12 +120,9 @@ char *get_instruction_operand(char **ptr, int num_of_commas_expected)
 
 int get_instruction_num_of_args(char *name)
 {
-    int i;
-    for (i = 0; i < NUM_OF_INSTRUCTIONS; i++)
-    {/* Search for the instruction name in the INSTRUCTIONS table */
-        if (strcmp(name, INSTRUCTIONS[i].name) == 0)
-            return INSTRUCTIONS[i].num_of_args;
-    }
+    instruction_info *instruction = find_instruction(name, strlen(name));
+    if (instruction != NULL)
+        return instruction->num_of_args;
     /* Invalid instruction */
     return GARBAGE_VALUE;
 }
@@ -106,20 +133,16 @@ char *get_label_name(char *ptr)
     int label_length = 0;
 
     /* Skip whitespaces */
-    while (isspace(*ptr))
-        ptr++;
+    ptr = skip_chars_of_class(ptr, WHITESPACE_CHAR_CLASS);
 
     if (!isalpha(*ptr))
         /* Label must start with an alphabetic symbol */
         return NULL;
 
-    /* Find the length of the label */
-    while (isalpha(*(ptr + label_length)) || isdigit(*(ptr + label_length)))
-    {/* Label contains only alphabetic symbols and digits */
-        label_length++;
-    }
+    /* Find the length of the label (label contains only alphabetic symbols and digits) */
+    label_length = skip_chars_of_class(ptr, LABEL_CHAR_CLASS) - ptr;
 
-    if (*(ptr + label_length) != ':')
+    if (!IS_OF_CHAR_CLASS(*(ptr + label_length), COLON_CHAR_CLASS))
         /* Label must end with ':'  */
         return NULL;
 
@@ -143,14 +166,13 @@ char *get_label_name_and_advance(char **ptr)
     int label_length = 0, invalid_chars_error = 0;
 
     /* Skip whitespaces */
-    while (isspace(**ptr))
-        (*ptr)++;
+    *ptr = skip_chars_of_class(*ptr, WHITESPACE_CHAR_CLASS);
 
     /* Find the length of the label */
-    while (!isspace(*(*ptr + label_length)) && *(*ptr + label_length) != '\n' && *(*ptr + label_length) != '\0')
+    while (!IS_OF_CHAR_CLASS(*(*ptr + label_length), WHITESPACE_CHAR_CLASS) && *(*ptr + label_length) != '\0')
     {/* While label end is not reached */
         /* Check for invalid characters */
-        if (!isalpha(*(*ptr + label_length)) && !isdigit(*(*ptr + label_length)) && !invalid_chars_error) /* [!invalid_chars_error] to avoid printing the error message multiple times */
+        if (!IS_OF_CHAR_CLASS(*(*ptr + label_length), LABEL_CHAR_CLASS) && !invalid_chars_error) /* [!invalid_chars_error] to avoid printing the error message multiple times */
         {/* Error - Label name must contain only alphabetic symbols and digits */
             print_error(ERROR_18, AM_FILE_STAGE);
             invalid_chars_error = 1;
@@ -184,6 +206,12 @@ char *get_label_name_and_advance(char **ptr)
         return NULL;
     }
 
+    /* Check if label name matches any reserved name */
+    if (is_reserved_name_slice(*ptr, label_length))
+    {
+        print_error(ERROR_12, AM_FILE_STAGE);
+    }
+
     /* Allocate memory for label_name */
     label_name = safe_malloc((label_length + 1) * sizeof(char));  /* +1 for \0 */
 
@@ -191,12 +219,6 @@ char *get_label_name_and_advance(char **ptr)
     strncpy(label_name, *ptr, label_length);
     *(label_name + label_length) = '\0';  /* Null termination */
 
-    /* Check if label name matches any reserved name */
-    if (is_reserved_name(label_name))
-    {
-        print_error(ERROR_12, AM_FILE_STAGE);
-    }
-
     /* Advance pointer to the character after the label name  */
     *ptr += label_length;
 
@@ -205,24 +227,27 @@ char *get_label_name_and_advance(char **ptr)
 
 int get_instruction_opcode(char *name)
 {
-    int i;
-    for (i = 0; i < NUM_OF_INSTRUCTIONS; i++)
-    {/* Search for the instruction name in the INSTRUCTIONS table */
-        if (strcmp(name, INSTRUCTIONS[i].name) == 0)
-            return INSTRUCTIONS[i].opcode;
-    }
+    instruction_info *instruction = find_instruction(name, strlen(name));
+    if (instruction != NULL)
+        return instruction->opcode;
     /* Invalid instruction */
     return 0;
 }
 
 int get_instruction_funct(char *name)
 {
-    int i;
-    for (i = 0; i < NUM_OF_INSTRUCTIONS; i++)
-    {/* Search for the instruction name in the INSTRUCTIONS table */
-        if (strcmp(name, INSTRUCTIONS[i].name) == 0)
-            return INSTRUCTIONS[i].funct;
-    }
+    instruction_info *instruction = find_instruction(name, strlen(name));
+    if (instruction != NULL)
+        return instruction->funct;
+    /* Invalid instruction */
+    return 0;
+}
+
+int get_instruction_first_word_template(char *name)
+{
+    instruction_info *instruction = find_instruction(name, strlen(name));
+    if (instruction != NULL)
+        return instruction->first_word_template;
     /* Invalid instruction */
     return 0;
 }
@@ -255,14 +280,14 @@ int get_register_number(char *operand, int is_source_operand)
     return 0;
 }
 
-int get_addressing_mode(char *instr_name, char *operand)
+int get_addressing_mode(char *instr_name, char *operand, int *immediate_value)
 {
     if (operand == NULL)
         /* NULL operand has no addressing mode (returning 0 is convenient for later use) */
         return 0;
 
     /* Find the addressing mode of the operand */
-    if (is_immediate_addressing_mode(operand))
+    if (is_immediate_addressing_mode(operand, immediate_value))
         return IMMEDIATE_ADDRESSING_MODE;
     if (is_register(operand))
         /* Addressing mode is: direct register */
@@ -276,9 +301,10 @@ int get_addressing_mode(char *instr_name, char *operand)
         return GARBAGE_VALUE;
 }
 
-int is_immediate_addressing_mode(char *operand)
+int is_immediate_addressing_mode(char *operand, int *immediate_value)
 {
-    return *operand == '#' && is_valid_number(operand + 1);
+    /* +1 in order to skip the '#' character */
+    return IS_OF_CHAR_CLASS(*operand, HASH_CHAR_CLASS) && parse_number(operand + 1, strlen(operand + 1), ADDITIONAL_WORD_LENGTH_IN_BITS, immediate_value);
 }
 
 int is_direct_addressing_mode(char *operand)
@@ -288,9 +314,11 @@ int is_direct_addressing_mode(char *operand)
 
 int is_relative_addressing_mode(char *instr_name, char *operand)
 {
-    if (strcmp(instr_name, "jmp") == 0 || strcmp(instr_name, "bne") == 0 || strcmp(instr_name, "jsr") == 0)
-    {/* Addressing mode can be relative only if the instruction name is: "jmp" or "bne" or "jsr" */
-        if (*operand == '&' && is_valid_label_syntax(operand + 1))
+    instruction_info *instruction = find_instruction(instr_name, strlen(instr_name));
+
+    if (instruction != NULL && (instruction->dest_valid_addressing_modes & RELATIVE_BIT))
+    {/* Addressing mode can be relative only for instructions that accept it (jmp, bne, jsr) */
+        if (IS_OF_CHAR_CLASS(*operand, AMPERSAND_CHAR_CLASS) && is_valid_label_syntax(operand + 1))
             return 1;
     }
     /* Addressing mode is not relative */
@@ -315,56 +343,54 @@ int is_register(char *operand)
     return 0;
 }
 
-char *get_directive_name(char **ptr)
+char *find_directive(char *name, int name_length)
 {
-    int i, directive_name_length;
+    int i;
 
     for (i = 0; i < NUM_OF_DIRECTIVES; i++)
     {/* Search for the directive name in the DIRECTIVES table */
-        directive_name_length = strlen(DIRECTIVES[i]);
-        if (strncmp(*ptr, DIRECTIVES[i], directive_name_length) == 0)
-        {/* Our pointer *starts* with a certain directive name */
-            if (isspace(*(*ptr + directive_name_length)) || *(*ptr + directive_name_length) == '\0')
-            {/* If it *ends* right after that - it is a valid directive name */
-                /* Update pointer location and return directive name */
-                *ptr += directive_name_length;
-                return DIRECTIVES[i];
-            }
-        }
+        if (strncmp(DIRECTIVES[i], name, name_length) == 0 && DIRECTIVES[i][name_length] == '\0')
+            return DIRECTIVES[i];
     }
-    /* No valid directive name has been found */
+    /* No directive with this name */
     return NULL;
 }
 
-int is_reserved_name(char *name)
+char *get_directive_name(char **ptr)
 {
-    /* Create duplicate of name (because 'get_instruction_name' and 'get_directive_name' change the pointing of the first char of the pointer they get) */
-    char *temp = safe_malloc((strlen(name) + 1) * sizeof(char)); /* +1 for \0 */
-    strcpy(temp, name);
+    char *directive_name;
+    int directive_name_length;
 
-    /* Check if name is equal to an instruction name */
-    if (get_instruction_name(&temp) != NULL)
-    {/* 'name' is equal to instruction name */
-        return 1;
-    }
+    /* The directive name ends with a whitespace or at the end of the line */
+    directive_name_length = find_char_of_class(*ptr, WHITESPACE_CHAR_CLASS) - *ptr;
 
-    /* Reset 'temp' because 'get_instruction_name' changed the first char pointed to */
-    strcpy(temp, name);
+    directive_name = find_directive(*ptr, directive_name_length);
+    if (directive_name != NULL)
+        /* Update pointer location */
+        *ptr += directive_name_length;
+
+    /* Return directive name (NULL if no valid directive name has been found) */
+    return directive_name;
+}
+
+int is_reserved_name(char *name)
+{
+    return is_reserved_name_slice(name, strlen(name));
+}
 
-    /* Check if name is equal to a directive name */
-    if (get_directive_name(&temp) != NULL)
-    {/* 'name' is equal to directive name */
+int is_reserved_name_slice(char *name, int name_length)
+{
+    /* Check if name is equal to an instruction name (a lookup in the hash table of the instruction names) */
+    if (find_instruction(name, name_length) != NULL)
         return 1;
-    }
 
-    /* Check if name is equal to a register name */
-    if (is_register(name))
-    {/* 'name' is equal to register name */
+    /* Check if name is equal to a directive name (all directive names start with '.') */
+    if (*name == '.' && find_directive(name, name_length) != NULL)
         return 1;
-    }
 
-    /* Free temporary variable */
-    free(temp);
+    /* Check if name is equal to a register name (r0, r1, ..., r7) */
+    if (name_length == REGISTER_NAME_LENGTH && *name == 'r' && *(name + 1) >= '0' && *(name + 1) < '0' + NUM_OF_REGISTERS)
+        return 1;
 
     /* Name is valid */
     return 0;
@@ -372,7 +398,6 @@ int is_reserved_name(char *name)
 
 void check_validity_of_label_name(char **ptr)
 {
-    char *label_name;
     int label_length = 0, invalid_chars_error = 0;
 
     /* Print error if needed */
@@ -389,10 +414,10 @@ void check_validity_of_label_name(char **ptr)
     }
 
     /* Find the length of the label */
-    while (*(*ptr + label_length) != ':')
+    while (!IS_OF_CHAR_CLASS(*(*ptr + label_length), COLON_CHAR_CLASS))
     {/* While label end is not reached */
         /* Check for invalid characters */
-        if (!isalpha(*(*ptr + label_length)) && !isdigit(*(*ptr + label_length)) && !invalid_chars_error) /* [!invalid_chars_error] to avoid printing the error message multiple times */
+        if (!IS_OF_CHAR_CLASS(*(*ptr + label_length), LABEL_CHAR_CLASS) && !invalid_chars_error) /* [!invalid_chars_error] to avoid printing the error message multiple times */
         {/* Error - Label name must contain only alphabetic symbols and digits */
             print_error(ERROR_18, AM_FILE_STAGE);
             invalid_chars_error = 1;
@@ -406,42 +431,30 @@ void check_validity_of_label_name(char **ptr)
         print_error(ERROR_19, AM_FILE_STAGE);
     }
 
-    /* Save label name */
-    label_name = safe_malloc((label_length + 1) * sizeof(char));  /* +1 for \0 */
-    strncpy(label_name, *ptr, label_length);
-    *(label_name + label_length) = '\0';  /* Null termination */
-    /* Check if label name matches any reserved name */
-    if (is_reserved_name(label_name))
+    /* Check if label name matches any reserved name (the label is checked in place, without copying it) */
+    if (is_reserved_name_slice(*ptr, label_length))
     {
         print_error(ERROR_12, AM_FILE_STAGE);
     }
 
     /* Move pointer to the character after ':'  */
     *ptr += label_length + 1;
-
-    /* Free temporary variable */
-    free(label_name);
 }
 
 int invalid_instruction_operand_type(char *instr_name, int operand_type, int is_source_operand)
 {
-    int i, j;
-    int *valid_types_array;  /* Pointer to the array of valid addressing modes for the instruction */
+    int valid_types;  /* Bitmask of the valid addressing modes for the operand */
+    instruction_info *instruction = find_instruction(instr_name, strlen(instr_name));
 
-    for (i = 0; i < NUM_OF_INSTRUCTIONS; i++)
-    {
-        if (strcmp(instr_name, INSTRUCTIONS[i].name) == 0)
-        {/* Found the instruction name */
-            /* Save the array of valid addressing modes for the instruction */
-            valid_types_array = is_source_operand ? INSTRUCTIONS[i].src_valid_addressing_modes : INSTRUCTIONS[i].dest_valid_addressing_modes;
-            for (j = 0; j < MAX_NUM_OF_VALID_ADDRESSING_MODES_FOR_PARAMETER && valid_types_array[j] != END_OF_ARRAY; j++)
-            {/* Check if the operand type is valid */
-                if (valid_types_array[j] == operand_type)
-                    return 0; /* Valid operand type */
-            }
-            return 1; /* Invalid operand type */
-        }
-    }
-    /* Invalid instruction name (error was already printed) */
-    return 0;
+    if (instruction == NULL)
+        /* Invalid instruction name (error was already printed) */
+        return 0;
+
+    if (operand_type < IMMEDIATE_ADDRESSING_MODE || operand_type > DIRECT_REGISTER_ADDRESSING_MODE)
+        /* Not an addressing mode at all */
+        return 1;
+
+    valid_types = is_source_operand ? instruction->src_valid_addressing_modes : instruction->dest_valid_addressing_modes;
+    /* Check if the operand type is valid */
+    return (valid_types & (1 << operand_type)) == 0;
 }
\ No newline at end of file
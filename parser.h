@@ -2,6 +2,39 @@
 #define PARSER_H
 
 
+#include "first_pass.h"
+
+/** The instructions of the language (generated from INSTRUCTIONS_SPEC in isa_spec.h) */
+extern instruction_info INSTRUCTIONS[NUM_OF_INSTRUCTIONS];
+
+/**
+ * Builds the hash table of the instruction names (INSTRUCTIONS_HASH_TABLE) from the INSTRUCTIONS table.
+ * It is called automatically on the first lookup.
+ *
+ * Input:
+ *   - No input
+ *
+ * Output:
+ *   - No return value
+ */
+void build_instructions_hash_table(void);
+
+
+/**
+ * Finds an instruction by its name (using the hash table of the instruction names).
+ * The name does not have to be null terminated.
+ *
+ * Input:
+ *   - name: Pointer to the first character of the name
+ *   - name_length: Number of characters in the name
+ *
+ * Output:
+ *   - Returns a pointer to the instruction in the INSTRUCTIONS table
+ *   - Returns NULL if there is no instruction with this name
+ */
+instruction_info *find_instruction(char *name, int name_length);
+
+
 /**
  * Finds the instruction name from the current position in the line.
  * Advances the pointer to the position after the instruction name.
@@ -98,6 +131,20 @@ int get_instruction_opcode(char *name);
 int get_instruction_funct(char *name);
 
 
+/**
+ * Gets the first word template of an instruction: the fields of its first word that do not depend on the operands
+ * (opcode, funct and A,R,E).
+ *
+ * Input:
+ *   - name: The instruction name
+ *
+ * Output:
+ *   - Returns the first word template of the instruction
+ *   - Returns 0 if the instruction name is invalid
+ */
+int get_instruction_first_word_template(char *name);
+
+
 /**
  * Gets the register number from a register operand.
  *
@@ -118,26 +165,28 @@ int get_register_number(char *operand, int is_source_operand);
  * Input:
  *   - instr_name: The name of the instruction
  *   - operand: String representing the operand to analyze
+ *   - immediate_value: Pointer to where the value of the operand is stored (if it is in immediate addressing mode)
  *
  * Output:
  *   - Returns the addressing mode code (0-3) for the operand
  *   - Returns 0 if operand is NULL (no addressing mode)
  *   - Returns GARBAGE_VALUE if the addressing mode is invalid
  */
-int get_addressing_mode(char *instr_name, char *operand);
+int get_addressing_mode(char *instr_name, char *operand, int *immediate_value);
 
 
 /**
- * Checks if the given operand uses immediate addressing mode.
+ * Checks if the given operand uses immediate addressing mode, and parses its value.
  *
  * Input:
  *   - operand: String representing the operand to check
+ *   - immediate_value: Pointer to where the value of the operand is stored (if it is in immediate addressing mode)
  *
  * Output:
- *   - Returns 1 (true) if the operand is in immediate addressing mode (starts with '#' followed by a valid number)
+ *   - Returns 1 (true) if the operand is in immediate addressing mode (starts with '#' followed by a valid number that fits in 21 bits)
  *   - Returns 0 (false) otherwise
  */
-int is_immediate_addressing_mode(char *operand);
+int is_immediate_addressing_mode(char *operand, int *immediate_value);
 
 
 /**
@@ -181,6 +230,20 @@ int is_relative_addressing_mode(char *instr_name, char *operand);
 int is_register(char *operand);
 
 
+/**
+ * Finds a directive by its name. The name does not have to be null terminated.
+ *
+ * Input:
+ *   - name: Pointer to the first character of the name
+ *   - name_length: Number of characters in the name
+ *
+ * Output:
+ *   - Returns a pointer to the directive name from the DIRECTIVES array
+ *   - Returns NULL if there is no directive with this name
+ */
+char *find_directive(char *name, int name_length);
+
+
 /**
  * Finds the directive name from the current position in the line.
  * Advances the pointer to the position after the directive name.
@@ -209,6 +272,21 @@ char *get_directive_name(char **ptr);
 int is_reserved_name(char *name);
 
 
+/**
+ * Checks if a given name is a reserved word in the assembly language (like 'is_reserved_name').
+ * The name does not have to be null terminated, so a name can be checked in place (without copying it).
+ *
+ * Input:
+ *   - name: Pointer to the first character of the name
+ *   - name_length: Number of characters in the name
+ *
+ * Output:
+ *   - Returns 1 (true) if the name is reserved
+ *   - Returns 0 (false) if the name is not reserved
+ */
+int is_reserved_name_slice(char *name, int name_length);
+
+
 /**
  * Validates a label name and checks it against language rules.
  * Advances the pointer to the character after the label (after the colon).
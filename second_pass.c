@@ -5,6 +5,11 @@
 #include "table.h"
 #include "errors.h"
 #include "parser.h"
+#include "binary_object.h"
+
+
+/* The hexadecimal digits by their value (a nibble is converted to its digit with a single lookup) */
+char HEX_DIGITS[] = "0123456789abcdef";
 
 
 /* This class contains the functions for the second pass stage of the assembler program.
@@ -13,220 +18,370 @@
  */
 
 
-void second_pass_stage(code_data_array **code, code_data_array **data, label_table **label_table, general_table **entries, general_table **externs, int ICF, int DCF, int label_table_lines, int *entries_lines, int *externs_lines, char *file_name, FILE *file)
+void second_pass_stage(word_store *code, word_store *data, symbol_table *symbols, general_table **entries, general_table **externs, int ICF, int DCF, int *entries_lines, int *externs_lines, char *file_name, assembler_options *options)
 {
-    /* Go back to the beginning of the file (in order to pass over it a second time) */
-    rewind(file);
-
     /* Add 'entry' type to label table (for labels that have been declared as entry in our file) */
-    add_entry_type_to_label_table(label_table, label_table_lines, file);
+    add_entry_type_to_label_table(symbols);
 
     /* Build the entries table */
-    build_entries_table(entries, label_table, entries_lines, label_table_lines);
+    build_entries_table(entries, symbols, entries_lines);
 
     /*
      * Update the machine code of label operands (using the label table)
      * The function also adds lines to the 'externs' table (if necessary).
      * I decided to do it inside this function in order to save time complexity (of going over the code table twice [and searching for each ;ines representing an operand its corresponding label in the label table]).
      */
-    update_machine_code_of_label_operands(code, label_table, externs, ICF, label_table_lines, externs_lines);
+    update_machine_code_of_label_operands(code, symbols, externs, externs_lines);
 
     if (current_error_number == ERROR_0)
     {/* Create the output files only if error has not been found */
-        create_output_files(code, data, label_table, entries, externs, ICF, DCF, label_table_lines, *entries_lines, *externs_lines, file_name);
+        create_output_files(code, data, symbols, entries, externs, ICF, DCF, *entries_lines, *externs_lines, file_name, options);
     }
 }
 
-void add_entry_type_to_label_table(label_table **label_table, int label_table_lines, FILE *file)
+void add_entry_type_to_label_table(symbol_table *symbols)
 {
-    int i, label_updated = 0;       /* 'label_updated' indicates if label was updated in label table (for error checking) */
-    char line[MAX_LINE_LENGTH];     /* Buffer to store each line read from the file */
-    char *ptr;                      /* Pointer to the current character */
-    char *directive_name, *entry_label;
-
-    while (fgets(line, sizeof(line), file))
-    {/* Read line by line, and find out it's type */
-        /* Update current line number */
-        current_line_number++;
-
-        /* Pointer to the beginning of the line */
-        ptr = line;
-
-        while (isspace(*ptr))
-        {/* Skip all whitespaces (for 'Empty line' check) */
-            ptr++;
-        }
-        if (*ptr == '\n' || *ptr == '\0')
-        {/* Empty line => skip it */
-            continue;
-        }
-
-        if (*ptr == ';')
-        {/* Comment line => skip it */
+    int i;
+    label_table *label;             /* The line of the entry label in the label table */
+
+    for (i = 0; i < symbols->entry_requests_lines; i++)
+    {/* Go over the .entry directives of the file (by their order in the file) */
+        /* Update current line number (for error messages) */
+        current_line_number = symbols->entry_requests[i].line_number;
+
+        /* Find the label in the label table (a lookup in its hash index) */
+        label = find_label(symbols, symbols->entry_requests[i].label);
+        if (label == NULL)
+        {/* Label not found in label table (checked for each .entry directive) */
+            print_error(ERROR_36, AM_FILE_STAGE);
             continue;
         }
 
-        directive_name = get_directive_name(&ptr);
-        if (directive_name != NULL && strcmp(directive_name, ".entry") == 0)
-        {/* Entry directive found */
-            /* Parse and get the label name */
-            entry_label = get_label_name_and_advance(&ptr);
-
-            /* Print error if extra characters are found at the end of the line */
-            check_no_extra_chars(&ptr);
-
-            if (entry_label == NULL)
-                /* Invalid label name */
-                continue;
-
-            for (i = 0; i < label_table_lines; i++)
-            {/* Go over each label */
-                if (strcmp(entry_label, (*label_table + i)->label) == 0)
-                {/* Matching label has been found => Update its type */
-                    if ((*label_table + i)->secondary_type != NULL && strcmp((*label_table + i)->secondary_type, EXTERN_TYPE) == 0)
-                    {/* Label type is already external (error checking is valid because external type is defined in the first pass stage) */
-                        print_error(ERROR_10, AM_FILE_STAGE);
-                    }
-                    /* Update entry type in label table */
-                    (*label_table + i)->secondary_type = ENTRY_TYPE;
-                    label_updated = 1;
-                    break;
-                }
-            }
-            if (label_updated == 0)
-                /* Label not found in label table */
-                print_error(ERROR_36, AM_FILE_STAGE);
+        /* Matching label has been found => Update its type */
+        if (label->flags & EXTERN_FLAG)
+        {/* Label type is already external (error checking is valid because external type is defined in the first pass stage) */
+            print_error(ERROR_10, AM_FILE_STAGE);
         }
+        /* Update entry type in label table */
+        label->flags |= ENTRY_FLAG;
     }
     /* Reset current line number */
     current_line_number = 0;
 }
 
-void build_entries_table(general_table **entries, label_table **label_table, int *entries_lines, int label_table_lines)
+void build_entries_table(general_table **entries, symbol_table *symbols, int *entries_lines)
 {
     int i;
-    for (i = 0; i < label_table_lines; i++)
-    {/* Go over each label */
-        if ((*label_table + i)->secondary_type != NULL && strcmp((*label_table + i)->secondary_type, ENTRY_TYPE) == 0)
+    int entries_capacity = 0;  /* The entries table is built only here => its capacity is not needed after it */
+    for (i = 0; i < symbols->lines; i++)
+    {/* Go over each label (by the order of their definition) */
+        if (symbols->labels[i].flags & ENTRY_FLAG)
         {/* Label type is entry */
-            add_to_entries_externs_table(entries, (*label_table + i)->address, (*label_table + i)->label, entries_lines);
+            add_to_entries_externs_table(entries, symbols->labels[i].address, symbols->labels[i].label, entries_lines, &entries_capacity);
         }
     }
 }
 
-void update_machine_code_of_label_operands(code_data_array **code, label_table **label_table, general_table **externs, int ICF, int label_table_lines, int *externs_lines)
+void encode_fixup_word(word_store *code, fixup *label_fixup, label_table *label)
 {
-    int i, j;                        /* Indexes for loops */
-    char word_in_binary[WORD_SIZE];  /* Array to store the binary representation of a word (used if necessary) */
-    char *current_label;             /* Pointer to the current label in the code table */
-    int jumping_distance;            /* Distance between the label address to the current code line address (used if necessary) */
-    int operand_was_encoded = 0;     /* Indicates if the operand was encoded (used for error checking) */
-
-    for (i = 0; i < ICF-INITIAL_IC_VALUE; i++)
-    {/* Go over each code line */
-        if ((*code + i)->machine_code == 0)
-        {/* Empty word has been reached */
-            /* Reset the flag */
-            operand_was_encoded = 0;
-            current_label = (*code + i)->label;
-            if (is_direct_addressing_mode(current_label))
-            {/* Direct addressing mode */
-                for (j = 0; j < label_table_lines; j++)
-                {/* Find it's matching label */
-                    if (strcmp(current_label, (*label_table + j)->label) == 0)
-                    {/* Matching label has been found => Encode its address (according to direct addressing mode) */
-                        if ((*label_table + j)->secondary_type != NULL && strcmp((*label_table + j)->secondary_type, EXTERN_TYPE) == 0)
-                        {/* Label type is external */
-                            add_to_entries_externs_table(externs, i+INITIAL_IC_VALUE, (*label_table + j)->label, externs_lines);
-                        }
-                        /* Create the word representing the direct addressing mode operand */
-                        direct_operand_word_to_binary((*label_table + j)->address, word_in_binary);
-                        /* Replace it in code table */
-                        (*code + i)->machine_code = strtol(word_in_binary, NULL, BINARY_BASE);
-                        /* Update flag */
-                        operand_was_encoded = 1;
-                    }
-                }
-            }
+    if (label_fixup->kind == DIRECT_ADDRESSING_MODE)
+        /* Create the word representing the direct addressing mode operand, and replace it in code table */
+        code->words[label_fixup->index - code->first_index] = direct_operand_word_to_binary(label->address, label->flags & EXTERN_FLAG);
+    else
+        /*
+         * Create the word representing the relative addressing mode operand, and replace it in code table
+         * (the jumping distance is calculated from the address of the 'first word' of the instruction line => -1)
+         */
+        code->words[label_fixup->index - code->first_index] = relative_operand_word_to_binary(label->address - (INITIAL_IC_VALUE + label_fixup->index - 1));
+}
+
+void resolve_new_fixups(word_store *code, symbol_table *symbols, int first_new_fixup, int pool_kept_names)
+{
+    int i, kept = first_new_fixup;  /* 'kept' is the number of fixups that are kept (the resolved fixups are removed) */
+    label_table *label;             /* The line of the label of the current fixup in the label table */
+    label_table *chain;             /* The line of the label of the current fixup in the forward references */
+
+    for (i = first_new_fixup; i < code->fixups_lines; i++)
+    {/* Go over the fixups of the current instruction */
+        label = find_label(symbols, code->fixups[i].label);
+        if (label != NULL && (label->flags & CODE_FLAG))
+        {/* The address of the label is final => encode the word (the fixup is not needed anymore) */
+            encode_fixup_word(code, &code->fixups[i], label);
+            continue;
+        }
+
+        code->fixups[kept] = code->fixups[i];
+        if (pool_kept_names)
+            /* The operand string is freed with the instruction line => the fixup keeps its own copy of the name */
+            code->fixups[kept].label = add_to_name_pool(symbols, code->fixups[kept].label);
+        if (label == NULL)
+        {/* The label is not defined yet => add the fixup to the head of its chain */
+            chain = find_label(symbols->forward_references, code->fixups[kept].label);
+            if (chain == NULL)
+                add_to_label_table(symbols->forward_references, kept, code->fixups[kept].label, 0);
             else
-            {/* An empty word can appear only if operand is a label => If addressing mode is not direct, it is relative */
-                current_label += 1;  /* Skip the '&' character */
-                for (j = 0; j < label_table_lines; j++)
-                {/* Find it's matching label */
-                    if (strcmp(current_label, (*label_table + j)->label) == 0)
-                    {/* Matching label has been found => Encode its jumping distance (according to relative addressing mode) */
-                        if ((*label_table + j)->address == 0)
-                        {/* Label address is external */
-                            print_error(ERROR_8, AM_FILE_STAGE);
-                        }
-                        /* Calculate the jumping distance (-1 in order to take the address of the 'first word' of the current instruction line) */
-                        jumping_distance = (*label_table + j)->address - (*code + i - 1)->address;
-                        /* Create the word representing the relative addressing mode operand */
-                        relative_operand_word_to_binary(jumping_distance, word_in_binary);
-                        /* Replace it in code table */
-                        (*code + i)->machine_code = strtol(word_in_binary, NULL, BINARY_BASE);
-                        /* Update flag */
-                        operand_was_encoded = 1;
-                    }
-                }
+            {
+                code->fixups[kept].next = chain->address;
+                chain->address = kept;
             }
-            if (operand_was_encoded == 0)
-            {/* Label was never declared */
-                current_line_number = (*code + i)->line_number;  /* Update current line number for error checking */
-                print_error(ERROR_37, AM_FILE_STAGE);
+        }
+        kept++;
+    }
+    code->fixups_lines = kept;
+}
+
+void flush_resolved_code_words(word_store *code)
+{
+    int end;  /* Index of the first word that is not final */
+
+    while (code->first_pending_fixup < code->fixups_lines && code->fixups[code->first_pending_fixup].kind == RESOLVED_FIXUP)
+        /* The fixups are by increasing index, and a resolved fixup stays resolved => the search continues from the last position */
+        code->first_pending_fixup++;
+    end = (code->first_pending_fixup < code->fixups_lines) ? code->fixups[code->first_pending_fixup].index : code->first_index + code->lines;
+
+    if (end - code->first_index >= STREAM_FLUSH_WORDS && 2 * (end - code->first_index) >= code->lines)
+        write_code_words_to_spool(code, end);
+}
+
+void write_code_words_to_spool(word_store *code, int end)
+{
+    int i, num_of_words = end - code->first_index;
+    char buffer[OBJECT_BUFFER_SIZE];     /* The lines that were not written to the spool yet */
+    int length = 0;                      /* Number of characters in the buffer */
+    char address_digits[ADDRESS_DIGITS]; /* The address of the next line in decimal digits */
+
+    format_address_digits(address_digits, INITIAL_IC_VALUE + code->first_index);
+    for (i = 0; i < num_of_words; i++)
+        add_object_line(code->spool, buffer, &length, address_digits, code->words[i]);
+    fwrite(buffer, 1, length, code->spool);
+
+    /* Keep only the rest of the words (the index of a word in the array is its index - 'first_index') */
+    memmove(code->words, code->words + num_of_words, (code->lines - num_of_words) * sizeof(int));
+    code->lines -= num_of_words;
+    code->first_index = end;
+}
+
+void write_data_words_to_spool(word_store *data)
+{
+    int i, run = 0;
+    data_spool_line line;
+
+    for (i = 0; i < data->lines; i++)
+    {/* A .space/.fill run is one line in the data table => it is one record in the spool as well */
+        line.repeat_count = (run < data->runs_lines && data->runs[run].index == i) ? data->runs[run++].repeat_count : 1;
+        line.word = data->words[i];
+        fwrite(&line, sizeof(data_spool_line), 1, data->spool);
+    }
+
+    /* The table starts over (its arrays are kept for the next lines) */
+    data->lines = data->runs_lines = 0;
+}
+
+void backpatch_label(word_store *code, symbol_table *symbols, char *label_name)
+{
+    int i;
+    label_table *label = find_label(symbols, label_name);
+    label_table *chain = find_label(symbols->forward_references, label_name);
+
+    if (chain == NULL || label == NULL || !(label->flags & CODE_FLAG))
+        /* The label was not referenced before, or it is not a code label (it was already defined with another type) */
+        return;
+
+    for (i = chain->address; i != NO_FIXUP; i = code->fixups[i].next)
+    {/* Go over the chain of the label */
+        encode_fixup_word(code, &code->fixups[i], label);
+        code->fixups[i].kind = RESOLVED_FIXUP;
+        code->resolved_fixups++;
+    }
+    chain->address = NO_FIXUP;
+
+    if (2 * code->resolved_fixups > code->fixups_lines)
+        /* Most of the fixups are resolved => remove them (the removal costs O(1) amortized per resolved fixup) */
+        remove_resolved_fixups(code, symbols);
+}
+
+void remove_resolved_fixups(word_store *code, symbol_table *symbols)
+{
+    int i, kept = 0;        /* 'kept' is the number of fixups that are kept (the fixups that are still pending) */
+    label_table *chain;     /* The line of the label of the current fixup in the forward references */
+
+    for (i = 0; i < code->fixups_lines; i++)
+    {/* Move the pending fixups to the start of the array (their order is kept) */
+        if (code->fixups[i].kind == RESOLVED_FIXUP)
+            continue;
+        code->fixups[kept] = code->fixups[i];
+        code->fixups[kept].next = NO_FIXUP;
+        /* The indexes of the fixups changed => the chains are built again (the chain of the label is emptied first) */
+        chain = find_label(symbols->forward_references, code->fixups[kept].label);
+        if (chain != NULL)
+            chain->address = NO_FIXUP;
+        kept++;
+    }
+
+    for (i = 0; i < kept; i++)
+    {/* Add each fixup to the head of the chain of its label (by increasing index => the chains keep their order) */
+        chain = find_label(symbols->forward_references, code->fixups[i].label);
+        if (chain != NULL)
+        {
+            code->fixups[i].next = chain->address;
+            chain->address = i;
+        }
+    }
+
+    code->fixups_lines = kept;
+    code->resolved_fixups = 0;
+    code->first_pending_fixup = 0;
+}
+
+void update_machine_code_of_label_operands(word_store *code, symbol_table *symbols, general_table **externs, int *externs_lines)
+{
+    int i;                           /* Index for loop */
+    int externs_capacity = 0;        /* The externals table is built only here => its capacity is not needed after it */
+    label_table *label;              /* The line of the current label in the label table */
+
+    for (i = 0; i < code->fixups_lines; i++)
+    {/* Go over each fixup (only the words of the fixups are empty) */
+        if (code->fixups[i].kind == RESOLVED_FIXUP)
+            /* The word was already encoded in the first pass (single pass mode) */
+            continue;
+
+        /* Find it's matching label (a lookup in the hash index of the label table) */
+        label = find_label(symbols, code->fixups[i].label);
+        if (label == NULL)
+        {/* Label was never declared */
+            current_line_number = code->fixups[i].line_number;  /* Update current line number for error checking */
+            print_error(ERROR_37, AM_FILE_STAGE);
+            continue;
+        }
+
+        if (label->flags & EXTERN_FLAG)
+        {/* Label type is external */
+            if (code->fixups[i].kind == DIRECT_ADDRESSING_MODE)
+                add_to_entries_externs_table(externs, code->fixups[i].index + INITIAL_IC_VALUE, label->label, externs_lines, &externs_capacity);
+            else
+            {/* An external label has no address to jump to */
+                current_line_number = code->fixups[i].line_number;  /* Update current line number for error checking */
+                print_error(ERROR_8, AM_FILE_STAGE);
             }
         }
+        encode_fixup_word(code, &code->fixups[i], label);
     }
+    /* Reset current line number */
+    current_line_number = 0;
 }
 
-void create_output_files(code_data_array **code, code_data_array **data, label_table **label_table, general_table **entries, general_table **externs, int ICF, int DCF, int label_table_lines, int entries_lines, int externs_lines, char *file_name)
+void create_output_files(word_store *code, word_store *data, symbol_table *symbols, general_table **entries, general_table **externs, int ICF, int DCF, int entries_lines, int externs_lines, char *file_name, assembler_options *options)
 {
-    /* File names */
-    char *object_file_name, *entries_file_name, *externals_file_name;
-    /* File pointers */
-    FILE *object_file, *entries_file, *externals_file;
+    int i, failed = 0;
+    char *file_names[NUM_OF_OUTPUT_FILES];            /* The names of the output files (by OBJECT_OUTPUT, ENTRIES_OUTPUT and EXTERNALS_OUTPUT) */
+    char *other_object_file_name;                     /* The object file of the other format (".ob" or BINARY_OBJECT_EXTENSION) */
+    char *temporary_file_names[NUM_OF_OUTPUT_FILES];  /* The names of the files they are written to first */
+    int created[NUM_OF_OUTPUT_FILES];                 /* Indicates if the file is created (the entries/externals file only if its table is not empty) */
+    FILE *file;
 
     /* Create the names of the output files */
-    object_file_name = get_file_name(2, file_name, ".ob");
-    entries_file_name = get_file_name(2, file_name, ".ent");
-    externals_file_name = get_file_name(2, file_name, ".ext");
-
-    /* Create the object file */
-    object_file = safe_fopen(object_file_name, "w");
-    create_object_file(object_file, code, data, ICF, DCF);
-    fclose(object_file);
-
-    /* Create the entries file (if entries table is not empty) */
-    if (*entries != NULL)
-    {
-        entries_file = safe_fopen(entries_file_name, "w");
-        create_entries_file(entries_file, entries, entries_lines);
-        fclose(entries_file);
+    file_names[OBJECT_OUTPUT] = get_file_name(2, file_name, options->object_format == BINARY_OBJECT_FORMAT ? BINARY_OBJECT_EXTENSION : ".ob");
+    file_names[ENTRIES_OUTPUT] = get_file_name(2, file_name, ".ent");
+    file_names[EXTERNALS_OUTPUT] = get_file_name(2, file_name, ".ext");
+    created[OBJECT_OUTPUT] = 1;
+    created[ENTRIES_OUTPUT] = (*entries != NULL);
+    created[EXTERNALS_OUTPUT] = (*externs != NULL);
+
+    for (i = 0; i < NUM_OF_OUTPUT_FILES; i++)
+    {/* Write each output file to its temporary file (the existing output files are not changed yet) */
+        temporary_file_names[i] = get_file_name(2, file_names[i], TEMPORARY_FILE_EXTENSION);
+        if (!created[i])
+            continue;
+        file = safe_fopen(temporary_file_names[i], (i == OBJECT_OUTPUT && options->object_format == BINARY_OBJECT_FORMAT) ? "wb" : "w");
+        if (file == NULL)
+        {
+            created[i] = 0;
+            failed = 1;
+            continue;
+        }
+
+        if (i == OBJECT_OUTPUT && options->object_format == BINARY_OBJECT_FORMAT)
+            /* Binary object file (it includes the entries and the externals as well) */
+            create_binary_object_file(file, code, data, ICF, DCF, *entries, entries_lines, *externs, externs_lines);
+        else if (i == OBJECT_OUTPUT)
+            create_object_file(file, code, data, ICF, DCF);
+        else if (i == ENTRIES_OUTPUT)
+            create_entries_file(file, entries, entries_lines);
+        else
+            create_externals_file(file, externs, externs_lines);
+
+        /* A write error (e.g. a full disk) may be reported only when the file is closed */
+        if (ferror(file))
+            failed = 1;
+        if (fclose(file) != 0)
+            failed = 1;
     }
+    if (current_error_number != ERROR_0)
+        /* The object file was not created or is incomplete (too many words, or a spool of the stream mode failed) */
+        failed = 1;
+
+    for (i = 0; i < NUM_OF_OUTPUT_FILES; i++)
+    {/* Publish all the output files, or none of them */
+        if (failed)
+        {/* Delete the temporary files (the output files of an earlier run are not changed) */
+            if (created[i])
+                remove(temporary_file_names[i]);
+        }
+        else if (created[i])
+        {/* Replace the output file with its temporary file */
+            if (publish_output_file(temporary_file_names[i], file_names[i]) != ERROR_0)
+                print_error(ERROR_51, INTERNAL_ERROR_STAGE);
+        }
+        else
+            /* The file is not created in this run => delete the file of an earlier run (if there is one), so it is not taken as an output of this run */
+            remove(file_names[i]);
 
-    /* Create the externals file (if externs table is not empty) */
-    if (*externs != NULL)
-    {
-        externals_file = safe_fopen(externals_file_name, "w");
-        create_externals_file(externals_file, externs, externs_lines);
-        fclose(externals_file);
+        free(file_names[i]);
+        free(temporary_file_names[i]);
+    }
+    if (!failed)
+    {/* The object file of the other format is from an earlier run => delete it (if there is one), so it is not taken as an output of this run */
+        other_object_file_name = get_file_name(2, file_name, options->object_format == BINARY_OBJECT_FORMAT ? ".ob" : BINARY_OBJECT_EXTENSION);
+        remove(other_object_file_name);
+        free(other_object_file_name);
     }
+    if (failed && current_error_number == ERROR_0)
+        /* Writing failed (a file that could not be opened was already reported) */
+        print_error(ERROR_51, INTERNAL_ERROR_STAGE);
+}
 
-    /* Free the memory of the file names */
-    free(object_file_name);
-    free(entries_file_name);
-    free(externals_file_name);
+int publish_output_file(char *temporary_file_name, char *file_name)
+{
+    if (rename(temporary_file_name, file_name) == 0)
+        return ERROR_0;
+
+    /* On some systems rename does not replace an existing file => delete it and try again */
+    remove(file_name);
+    if (rename(temporary_file_name, file_name) == 0)
+        return ERROR_0;
+    remove(temporary_file_name);
+    return ERROR_51;
 }
 
-void create_object_file(FILE *file, code_data_array **code, code_data_array **data, int ICF, int DCF)
+void create_object_file(FILE *file, word_store *code, word_store *data, int ICF, int DCF)
 {
-    int i;
-    char *hex_str = NULL;  /* Buffer for the hexadecimal representation of the machine code
-                              Initialize to NULL in order to 'free' an initialized variable */
+    int i, j;
+    int repeat_count, run = 0;           /* The number of words of the current data line */
+    char buffer[OBJECT_BUFFER_SIZE];     /* The lines that were not written to the file yet */
+    int length = 0;                      /* Number of characters in the buffer */
+    size_t spool_length;                 /* Number of characters that were read from the spool */
+    data_spool_line spool_line;          /* A line that was read from the data spool */
+    char address_digits[ADDRESS_DIGITS]; /* The address of the next line in decimal digits (the addresses of the lines are consecutive) */
 
     if (ICF-INITIAL_IC_VALUE + DCF > MAX_NUM_OF_WORDS)
     {/* Check if the number of words in the object file exceeds the maximum number of words */
         print_error(ERROR_3, AM_FILE_STAGE);
+        return;
+    }
+    if ((code->spool != NULL && rewind_spool(code->spool) != ERROR_0) || (data->spool != NULL && rewind_spool(data->spool) != ERROR_0))
+    {/* Stream mode => a word was not written to its spool, so the object file would be incomplete */
+        print_error(ERROR_51, INTERNAL_ERROR_STAGE);
+        return;
     }
 
     /* Write ICF and DCF in the first line of the file */
@@ -237,19 +392,84 @@ void create_object_file(FILE *file, code_data_array **code, code_data_array **da
      * Address is written in 7 digits with leading zeros
      * And machine code is written in 6 digits with leading zeros
      */
-    for (i = 0; i < ICF-INITIAL_IC_VALUE; i++)
-    {
-        hex_str = convert_to_hexadecimal_base((*code + i)->machine_code);
-        fprintf(file, "%.7d %.6s\n", (*code + i)->address, hex_str);
+    if (code->spool != NULL)
+    {/* Stream mode => copy the lines of the code words that were already written */
+        while ((spool_length = fread(buffer, 1, OBJECT_BUFFER_SIZE, code->spool)) > 0)
+            fwrite(buffer, 1, spool_length, file);
+    }
+
+    format_address_digits(address_digits, INITIAL_IC_VALUE + code->first_index);
+    for (i = 0; i < code->lines; i++)
+    {/* The address of a code word is its index + INITIAL_IC_VALUE */
+        add_object_line(file, buffer, &length, address_digits, code->words[i]);
     }
-    for (i = 0; i < DCF; i++)
-    {
-        hex_str = convert_to_hexadecimal_base((*data + i)->machine_code);
-        fprintf(file, "%.7d %.6s\n", (*data + i)->address + ICF, hex_str); /* Add ICF to the address so that the data address will be after the code address */
+    if (data->spool != NULL)
+    {/* Stream mode => the data lines that were already written come first (their addresses follow the code addresses) */
+        while (fread(&spool_line, sizeof(data_spool_line), 1, data->spool) == 1)
+            for (j = 0; j < spool_line.repeat_count; j++)
+                add_object_line(file, buffer, &length, address_digits, spool_line.word);
     }
+    for (i = 0; i < data->lines; i++)
+    {/* Data addresses are after the code addresses (they start at ICF) */
+        /* A .space/.fill run is one line in the data table => it is expanded only here (a word per address) */
+        repeat_count = (run < data->runs_lines && data->runs[run].index == i) ? data->runs[run++].repeat_count : 1;
+        for (j = 0; j < repeat_count; j++)
+            add_object_line(file, buffer, &length, address_digits, data->words[i]);
+    }
+
+    /* Write the rest of the buffer */
+    fwrite(buffer, 1, length, file);
+
+    if ((code->spool != NULL && ferror(code->spool)) || (data->spool != NULL && ferror(data->spool)))
+        /* A spool could not be read to its end => the object file is incomplete */
+        print_error(ERROR_51, INTERNAL_ERROR_STAGE);
+}
+
+int rewind_spool(FILE *spool)
+{
+    /* The error indicator keeps a failure of any earlier write (fseek does not clear it, unlike rewind) */
+    if (fflush(spool) != 0 || ferror(spool) || fseek(spool, 0L, SEEK_SET) != 0)
+        return ERROR_51;
+    return ERROR_0;
+}
+
+void add_object_line(FILE *file, char *buffer, int *length, char *address_digits, int machine_code)
+{
+    char *line;
+
+    if (*length + OBJECT_LINE_LENGTH > OBJECT_BUFFER_SIZE)
+    {/* The buffer is full => write it to the file */
+        fwrite(buffer, 1, *length, file);
+        *length = 0;
+    }
+
+    /* Every line has the same width => the line is: the address digits, ' ', the hexadecimal digits and '\n' */
+    line = buffer + *length;
+    memcpy(line, address_digits, ADDRESS_DIGITS);
+    line[ADDRESS_DIGITS] = ' ';
+    convert_to_hexadecimal_base(machine_code, line + ADDRESS_DIGITS + 1);
+    line[OBJECT_LINE_LENGTH - 1] = '\n';
+    *length += OBJECT_LINE_LENGTH;
 
-    /* Free the memory of the hexadecimal string */
-    free(hex_str);
+    /* The next line has the next address */
+    increment_address_digits(address_digits);
+}
+
+void format_address_digits(char *address_digits, int address)
+{
+    int i;
+    for (i = ADDRESS_DIGITS - 1; i >= 0; i--, address /= DECIMAL_BASE)
+        /* From the least significant digit (the leading digits are zeros) */
+        address_digits[i] = (char)('0' + address % DECIMAL_BASE);
+}
+
+void increment_address_digits(char *address_digits)
+{
+    int i = ADDRESS_DIGITS - 1;
+    while (i > 0 && address_digits[i] == '9')
+        /* Carry: 9 becomes 0, and the digit to its left is incremented */
+        address_digits[i--] = '0';
+    address_digits[i]++;
 }
 
 void create_entries_file(FILE *file, general_table **entries, int entries_lines)
@@ -272,17 +492,12 @@ void create_externals_file(FILE *file, general_table **externs, int externs_line
     }
 }
 
-char *convert_to_hexadecimal_base(int machine_code)
+void convert_to_hexadecimal_base(int machine_code, char *hex_str)
 {
-    /* Buffer for 6 hex digits + a null terminator */
-    char *hex_str = safe_malloc(HEX_STR_SIZE * sizeof(char));
-    /*
-     * Convert the machine code to hexadecimal base:
-     * Format the machine_code integer as a hexadecimal number
-     * And pad it with zeros to a width of 6 characters
-     * Mask in order to use only 24 bits of machine_code (in order to fit within 6 hexadecimal digits)
-     * And write the result to the hex_str buffer
-     */
-    sprintf(hex_str, "%06x", machine_code & 0xFFFFFF);
-    return hex_str;
+    int i;
+    unsigned long bits = (unsigned long)machine_code;
+
+    for (i = HEX_DIGITS_PER_WORD - 1; i >= 0; i--, bits >>= BITS_PER_NIBBLE)
+        /* Each digit is a lookup of a nibble, from the least significant nibble (only the 24 bits of the word are used) */
+        hex_str[i] = HEX_DIGITS[bits & NIBBLE_MASK];
 }
\ No newline at end of file
@@ -9,37 +9,34 @@
  * Handles the second pass of the assembly process to complete machine code generation.
  *
  * Input:
- *   - code: Double pointer to the array containing machine code instructions
- *   - data: Double pointer to the array containing data segment
- *   - label_table: Double pointer to the table containing all labels
+ *   - code: Pointer to the code table
+ *   - data: Pointer to the data table
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - entries: Double pointer to the table that will store entry labels
  *   - externs: Double pointer to the table that will store external labels
  *   - ICF: Final instruction counter value from first pass
  *   - DCF: Final data counter value from first pass
- *   - label_table_lines: Number of lines in the label table
  *   - entries_lines: Pointer to store the count of entry labels
  *   - externs_lines: Pointer to store the count of external labels
  *   - file_name: Name of the source file being assembled
- *   - file: Pointer to the source file
+ *   - options: The options of the command line (the format of the object file)
  *
  * Output:
  *   - No return value
  */
-void second_pass_stage(code_data_array **code, code_data_array **data, label_table **label_table, general_table **entries, general_table **externs, int ICF, int DCF, int label_table_lines, int *entries_lines, int *externs_lines, char *file_name, FILE *file);
+void second_pass_stage(word_store *code, word_store *data, symbol_table *symbols, general_table **entries, general_table **externs, int ICF, int DCF, int *entries_lines, int *externs_lines, char *file_name, assembler_options *options);
 
 
 /**
- * Marks labels declared as entry types in the label table.
+ * Marks labels declared as entry types in the label table (from the .entry directives saved in the first pass).
  *
  * Input:
- *   - label_table: Double pointer to the table containing all labels
- *   - label_table_lines: Number of lines in the label table
- *   - file: Pointer to the source file being processed
+ *   - symbols: Pointer to the symbol table (the label table, its hash index and the .entry directives)
  *
  * Output:
  *   - No return value
  */
-void add_entry_type_to_label_table(label_table **label_table, int label_table_lines, FILE *file);
+void add_entry_type_to_label_table(symbol_table *symbols);
 
 
 /**
@@ -47,68 +44,244 @@ void add_entry_type_to_label_table(label_table **label_table, int label_table_li
  *
  * Input:
  *   - entries: Double pointer to the table that will store entry labels
- *   - label_table: Double pointer to the table containing all labels
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - entries_lines: Pointer to store the count of entry labels
- *   - label_table_lines: Number of lines in the label table
  *
  * Output:
  *   - No return value
  */
-void build_entries_table(general_table **entries, label_table **label_table, int *entries_lines, int label_table_lines);
+void build_entries_table(general_table **entries, symbol_table *symbols, int *entries_lines);
+
+/**
+ * Encodes the word of a fixup with the address of its label (according to the addressing mode of the fixup).
+ *
+ * Input:
+ *   - code: Pointer to the code table
+ *   - label_fixup: Pointer to the fixup
+ *   - label: Pointer to the label in the label table (its address, and whether it is external)
+ *
+ * Output:
+ *   - No return value
+ */
+void encode_fixup_word(word_store *code, fixup *label_fixup, label_table *label);
+
+
+/**
+ * Resolves the fixups that were added for the current instruction (single pass mode).
+ * A fixup of a code label that is already defined is encoded and removed. A fixup of an undefined label is added to the chain of the label
+ * (in the forward references), and the fixups of data and external labels are kept for the second pass (their address is known only then).
+ *
+ * Input:
+ *   - code: Pointer to the code table
+ *   - symbols: Pointer to the symbol table (with its forward references)
+ *   - first_new_fixup: Index of the first fixup of the current instruction
+ *   - pool_kept_names: 1 in stream mode - the label names of the kept fixups are copied to the name pool (the instruction line is freed), 0 otherwise
+ *
+ * Output:
+ *   - No return value
+ */
+void resolve_new_fixups(word_store *code, symbol_table *symbols, int first_new_fixup, int pool_kept_names);
+
+
+/**
+ * Writes the final code words to the spool of the code table (stream mode): the words before the first fixup that is
+ * still waiting for its label (or all the words if there is none). The words are written only when there are enough of them
+ * (at least STREAM_FLUSH_WORDS, and at least as many as the words that are kept), so moving the rest of the words costs O(1) amortized.
+ *
+ * Input:
+ *   - code: Pointer to the code table (with a spool)
+ *
+ * Output:
+ *   - No return value
+ */
+void flush_resolved_code_words(word_store *code);
+
+
+/**
+ * Writes the object file lines of the first code words to the spool of the code table, and removes them from the table.
+ * A write error stays in the error indicator of the spool (it is checked by rewind_spool before the spool is copied to the object file).
+ *
+ * Input:
+ *   - code: Pointer to the code table (with a spool)
+ *   - end: Index of the word after the last word to write
+ *
+ * Output:
+ *   - No return value
+ */
+void write_code_words_to_spool(word_store *code, int end);
+
+
+/**
+ * Writes all the lines of the data table to its spool (stream mode), as data_spool_line records (a .space/.fill run stays one record),
+ * and empties the table. A write error stays in the error indicator of the spool (it is checked by rewind_spool).
+ * The addresses of the data words are known only at the end (they start at ICF), so they are added when the
+ * object file is written.
+ *
+ * Input:
+ *   - data: Pointer to the data table (with a spool)
+ *
+ * Output:
+ *   - No return value
+ */
+void write_data_words_to_spool(word_store *data);
+
+
+/**
+ * Encodes the chain of fixups of a code label that was just defined (single pass mode), and marks them as resolved.
+ * The resolved fixups are removed when they are more than half of the fixups (see remove_resolved_fixups).
+ *
+ * Input:
+ *   - code: Pointer to the code table
+ *   - symbols: Pointer to the symbol table (with its forward references)
+ *   - label_name: The name of the label
+ *
+ * Output:
+ *   - No return value
+ */
+void backpatch_label(word_store *code, symbol_table *symbols, char *label_name);
+
+
+/**
+ * Removes the resolved fixups from the code table (single pass mode), so the table keeps only the fixups that are still
+ * waiting for their labels. The pending fixups keep their order, and the chains of their labels are built again with their new indexes.
+ *
+ * Input:
+ *   - code: Pointer to the code table
+ *   - symbols: Pointer to the symbol table (with its forward references)
+ *
+ * Output:
+ *   - No return value
+ */
+void remove_resolved_fixups(word_store *code, symbol_table *symbols);
+
 
 /**
  * Updates machine code for instructions that have label operands with their correct addresses.
+ * Only the fixups recorded in the first pass are visited, by the addressing mode saved in each fixup.
  *
  * Input:
- *   - code: Double pointer to the array containing machine code instructions
- *   - label_table: Double pointer to the table containing all labels
+ *   - code: Pointer to the code table
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - externs: Double pointer to the table that will store external labels
- *   - ICF: Final instruction counter value from first pass
- *   - label_table_lines: Number of lines in the label table
  *   - externs_lines: Pointer to store the count of external labels
  *
  * Output:
  *   - No return value
  */
-void update_machine_code_of_label_operands(code_data_array **code, label_table **label_table, general_table **externs, int ICF, int label_table_lines, int *externs_lines);
+void update_machine_code_of_label_operands(word_store *code, symbol_table *symbols, general_table **externs, int *externs_lines);
 
 
 /**
  * Creates all output files for the assembler (object, entries, externals).
+ * Each file is written to a temporary file ("<name>.tmp"), and only if all of them were written successfully they are renamed to their names,
+ * so an interrupted or failed run never leaves a truncated output file. An entries/externals file that is not created in this run
+ * (its table is empty) is deleted, so a file of an earlier run is not taken as an output of this run. For the same reason, the object file
+ * of the other format (".ob" for --format=bin, BINARY_OBJECT_EXTENSION otherwise) is deleted.
  *
  * Input:
- *   - code: Double pointer to the array containing machine code instructions
- *   - data: Double pointer to the array containing data segment
- *   - label_table: Double pointer to the table containing all labels
+ *   - code: Pointer to the code table
+ *   - data: Pointer to the data table
+ *   - symbols: Pointer to the symbol table (the label table and its hash index)
  *   - entries: Double pointer to the table containing entry labels
  *   - externs: Double pointer to the table containing external labels
  *   - ICF: Final instruction counter value from first pass
  *   - DCF: Final data counter value from first pass
- *   - label_table_lines: Number of lines in the label table
  *   - entries_lines: Number of entry labels
  *   - externs_lines: Number of external labels
  *   - file_name: Name of the source file being assembled
+ *   - options: The options of the command line (the format of the object file)
  *
  * Output:
  *   - No return value
  */
-void create_output_files(code_data_array **code, code_data_array **data, label_table **label_table, general_table **entries, general_table **externs, int ICF, int DCF, int label_table_lines, int entries_lines, int externs_lines, char *file_name);
+void create_output_files(word_store *code, word_store *data, symbol_table *symbols, general_table **entries, general_table **externs, int ICF, int DCF, int entries_lines, int externs_lines, char *file_name, assembler_options *options);
+
+
+/**
+ * Renames a temporary output file to the name of the output file (replacing the output file of an earlier run).
+ *
+ * Input:
+ *   - temporary_file_name: The name of the temporary file
+ *   - file_name: The name of the output file
+ *
+ * Output:
+ *   - Returns ERROR_0 if the file was renamed, or ERROR_51 otherwise (the temporary file is deleted)
+ */
+int publish_output_file(char *temporary_file_name, char *file_name);
 
 
 /**
  * Creates the object output file containing machine code in hexadecimal format.
+ * The lines are formatted into a buffer that is written to the file with a single fwrite when it is full.
+ * In stream mode the lines of the code words that were already written to the spool are copied from it first.
+ * If a spool could not be written or read, ERROR_51 is printed (the object file is incomplete => it is not published).
  *
  * Input:
  *   - file: Pointer to the file where the object code will be written
- *   - code: Double pointer to the array containing machine code instructions
- *   - data: Double pointer to the array containing data segment
+ *   - code: Pointer to the code table
+ *   - data: Pointer to the data table
  *   - ICF: Final instruction counter value from first pass
  *   - DCF: Final data counter value from first pass
  *
  * Output:
  *   - No return value
  */
-void create_object_file(FILE *file, code_data_array **code, code_data_array **data, int ICF, int DCF);
+void create_object_file(FILE *file, word_store *code, word_store *data, int ICF, int DCF);
+
+
+/**
+ * Prepares a spool of the stream mode for reading: writes the rest of its buffer and moves to its start.
+ *
+ * Input:
+ *   - spool: The spool
+ *
+ * Output:
+ *   - Returns ERROR_0 on success
+ *   - Returns ERROR_51 if a write to the spool failed (e.g. the temporary directory is full)
+ */
+int rewind_spool(FILE *spool);
+
+
+/**
+ * Adds a line to the buffer of the object file (the buffer is written to the file first if it is full):
+ * the address (7 digits), a space, the machine code (6 hexadecimal digits) and '\n'.
+ *
+ * Input:
+ *   - file: Pointer to the object file
+ *   - buffer: The buffer of the object file (of size OBJECT_BUFFER_SIZE)
+ *   - length: Pointer to the number of characters in the buffer
+ *   - address_digits: The address of the word in decimal digits (it is incremented to the address of the next line)
+ *   - machine_code: The machine code of the word
+ *
+ * Output:
+ *   - No return value
+ */
+void add_object_line(FILE *file, char *buffer, int *length, char *address_digits, int machine_code);
+
+
+/**
+ * Writes an address in decimal digits (7 digits with leading zeros, without a null terminator).
+ *
+ * Input:
+ *   - address_digits: Buffer of at least ADDRESS_DIGITS characters
+ *   - address: The address
+ *
+ * Output:
+ *   - No return value
+ */
+void format_address_digits(char *address_digits, int address);
+
+
+/**
+ * Increments an address that is written in decimal digits (the lines of the object file have consecutive addresses).
+ *
+ * Input:
+ *   - address_digits: The address (ADDRESS_DIGITS digits)
+ *
+ * Output:
+ *   - No return value
+ */
+void increment_address_digits(char *address_digits);
 
 
 /**
@@ -142,15 +315,16 @@ void create_externals_file(FILE *file, general_table **externs, int externs_line
 
 
 /**
- * Converts an integer machine code value to its hexadecimal string representation.
+ * Converts an integer machine code value to its hexadecimal representation (6 digits with leading zeros, using a table of the digits).
  *
  * Input:
  *   - machine_code: Integer value of the machine code to convert
+ *   - hex_str: Buffer of at least 6 characters for the digits (no null terminator is written)
  *
  * Output:
- *   - Returns a pointer to a string containing the hexadecimal representation
+ *   - No return value
  */
-char *convert_to_hexadecimal_base(int machine_code);
+void convert_to_hexadecimal_base(int machine_code, char *hex_str);
 
 
 #endif /* SECOND_PASS_H */
\ No newline at end of file
@@ -13,63 +13,261 @@
  * 3. Label table
  * 4. Entries table
  * 5. Externs table
+ * 6. Instruction table
  */
 
 
-void add_to_code_table(code_data_array **code, int *IC, char *word_in_binary, char *label)
+void *grow_table(void *table, int *capacity, int needed_lines, int line_size)
 {
-    /* Allocate memory */
-    *code = safe_realloc(*code, (*IC-INITIAL_IC_VALUE + 1) * sizeof(code_data_array));  /* +1 for the new line in the code table */
-    /* Store values in table */
-    (*code + (*IC-INITIAL_IC_VALUE))->machine_code = strtol(word_in_binary, NULL, BINARY_BASE);
-    (*code + (*IC-INITIAL_IC_VALUE))->address = *IC;
-    (*code + (*IC-INITIAL_IC_VALUE))->label = label;
-    (*code + (*IC-INITIAL_IC_VALUE))->line_number = current_line_number;
+    if (needed_lines > *capacity)
+    {/* Not enough space => grow geometrically (so the lines are copied O(1) times per line on average) */
+        if (*capacity == 0)
+            *capacity = INITIAL_WORD_STORE_CAPACITY;
+        while (needed_lines > *capacity)
+            *capacity *= 2;
+        table = safe_realloc(table, *capacity * line_size);
+    }
+    return table;
+}
+
+int *add_lines_to_word_store(word_store *store, int num_of_lines)
+{
+    int *first_word;
+
+    store->words = grow_table(store->words, &store->capacity, store->lines + num_of_lines, sizeof(int));
+    first_word = store->words + store->lines;
+    store->lines += num_of_lines;
+    return first_word;
+}
+
+void free_word_store(word_store *store)
+{
+    free(store->words);
+    free(store->fixups);
+    free(store->runs);
+    free(store->line_addresses);
+    store->words = NULL;
+    store->fixups = NULL;
+    store->runs = NULL;
+    store->line_addresses = NULL;
+    store->lines = store->capacity = 0;
+    store->fixups_lines = store->fixups_capacity = 0;
+    store->runs_lines = store->runs_capacity = 0;
+    store->line_addresses_lines = store->line_addresses_capacity = 0;
+    store->first_index = store->first_pending_fixup = store->resolved_fixups = 0;
+    if (store->spool != NULL)
+        fclose(store->spool);
+    store->spool = NULL;
+}
+
+void add_to_code_table(word_store *code, int *IC, int word)
+{
+    /* Store the word in table */
+    *add_lines_to_word_store(code, 1) = word;
     /* Increase counter */
     (*IC)++;
 }
 
-void add_to_data_table(code_data_array **data, int *DC, char *word_in_binary)
+void add_fixup_to_code_table(word_store *code, int *IC, char *label, int kind)
 {
-    /* Allocate memory */
-    *data = safe_realloc(*data, (*DC + 1) * sizeof(code_data_array));  /* +1 for the new line in the code table */
-    /* Store values in table */
-    (*data + *DC)->machine_code = strtol(word_in_binary, NULL, BINARY_BASE);
-    (*data + *DC)->address = *DC;
-    (*data + *DC)->label = NULL;
+    fixup *new_fixup;
+
+    /* Save the label for the second pass (the index of the word is its address - INITIAL_IC_VALUE) */
+    code->fixups = grow_table(code->fixups, &code->fixups_capacity, code->fixups_lines + 1, sizeof(fixup));
+    new_fixup = code->fixups + code->fixups_lines++;
+    new_fixup->index = *IC - INITIAL_IC_VALUE;
+    new_fixup->label = label;
+    new_fixup->kind = kind;
+    new_fixup->line_number = current_line_number;
+    new_fixup->next = NO_FIXUP;
+
+    /* Add an empty word in its place */
+    add_to_code_table(code, IC, 0);
+}
+
+void add_to_data_table(word_store *data, int *DC, int word)
+{
+    *add_cells_to_data_table(data, DC, 1) = word;
+}
+
+int *add_cells_to_data_table(word_store *data, int *DC, int num_of_cells)
+{
+    int i;
+    /* Allocate memory for all the new lines at once */
+    int *first_cell = add_lines_to_word_store(data, num_of_cells);
+
+    /* Initialize the words (their values are stored by the caller) */
+    for (i = 0; i < num_of_cells; i++)
+        first_cell[i] = 0;
     /* Increase counter */
-    (*DC)++;
+    *DC += num_of_cells;
+    return first_cell;
 }
 
-void add_to_label_table(label_table **table, int address, char *label_name, char *type, char *secondary_type, int *lines)
+void add_run_to_data_table(word_store *data, int *DC, int word, int repeat_count)
+{
+    word_run *run;
+
+    /* A single line represents all the words of the run */
+    add_to_data_table(data, DC, word);
+    data->runs = grow_table(data->runs, &data->runs_capacity, data->runs_lines + 1, sizeof(word_run));
+    run = data->runs + data->runs_lines++;
+    run->index = data->lines - 1;
+    run->repeat_count = repeat_count;
+    *DC += repeat_count - 1;  /* The first word was already counted */
+}
+
+void add_line_address(word_store *data, int address)
+{
+    line_address *line;
+
+    data->line_addresses = grow_table(data->line_addresses, &data->line_addresses_capacity, data->line_addresses_lines + 1, sizeof(line_address));
+    line = data->line_addresses + data->line_addresses_lines++;
+    line->line_number = current_line_number;
+    line->address = address;
+}
+
+encoded_instruction *add_to_instruction_table(encoded_instruction **table, int *lines, int *capacity)
+{
+    /* 'lines' - Points to the next empty line (the table grows geometrically) */
+    *table = grow_table(*table, capacity, *lines + 1, sizeof(encoded_instruction));
+    /* Increase the number of lines in the table, and return the new line */
+    return *table + (*lines)++;
+}
+
+void free_instruction_table(encoded_instruction *table, int lines)
 {
-    /* Check if label is already defined in the table */
     int i;
-    for (i = 0; i < *lines; i++)
-    {
-        if (strcmp((*table + i)->label, label_name) == 0)
-        {/* Label already exists in the table */
-            print_error(ERROR_11, AM_FILE_STAGE);
-            return;
-        }
+    for (i = 0; i < lines; i++)
+    {/* Free the strings that were allocated while parsing each instruction line */
+        free((table + i)->label);
+        free((table + i)->source_operand);
+        free((table + i)->destination_operand);
+    }
+    free(table);
+}
+
+void init_symbol_table(symbol_table *symbols, int estimated_num_of_labels)
+{
+    symbols->labels = NULL;
+    symbols->lines = 0;
+    symbols->capacity = 0;
+    symbols->hash_index = NULL;
+    symbols->entry_requests = NULL;
+    symbols->entry_requests_lines = 0;
+    symbols->entry_requests_capacity = 0;
+    symbols->forward_references = NULL;
+    symbols->name_pool = NULL;
+    symbols->name_pool_used = 0;
+
+    /* The hash index is at least twice as big as the number of labels (so the probing sequences are short) */
+    symbols->hash_size = INITIAL_SYMBOL_HASH_SIZE;
+    while (symbols->hash_size < 2 * estimated_num_of_labels)
+        symbols->hash_size *= 2;
+    build_symbol_hash_index(symbols);
+}
+
+void build_symbol_hash_index(symbol_table *symbols)
+{
+    int i;
+
+    free(symbols->hash_index);
+    symbols->hash_index = safe_malloc(symbols->hash_size * sizeof(symbol_hash_cell));
+    for (i = 0; i < symbols->hash_size; i++)
+        symbols->hash_index[i].line = EMPTY_HASH_CELL;
+
+    for (i = 0; i < symbols->lines; i++)
+        /* Insert each label */
+        index_label(symbols, i);
+}
+
+void index_label(symbol_table *symbols, int line)
+{
+    unsigned int hash = hash_string(symbols->labels[line].label);
+    int cell = (int)(hash & (symbols->hash_size - 1));
+
+    while (symbols->hash_index[cell].line != EMPTY_HASH_CELL)
+        /* Linear probing: the next cell is taken if the cell is not empty */
+        cell = (cell + 1) & (symbols->hash_size - 1);
+    symbols->hash_index[cell].hash = hash;
+    symbols->hash_index[cell].line = line;
+}
+
+label_table *find_label(symbol_table *symbols, char *label_name)
+{
+    unsigned int hash = hash_string(label_name);
+    int cell = (int)(hash & (symbols->hash_size - 1));
+
+    while (symbols->hash_index[cell].line != EMPTY_HASH_CELL)
+    {/* Go over the probing sequence until an empty cell is reached (the names are compared only if their hashes are equal) */
+        if (symbols->hash_index[cell].hash == hash && strcmp(symbols->labels[symbols->hash_index[cell].line].label, label_name) == 0)
+            return &symbols->labels[symbols->hash_index[cell].line];
+        cell = (cell + 1) & (symbols->hash_size - 1);
+    }
+    /* Label not found */
+    return NULL;
+}
+
+void add_to_label_table(symbol_table *symbols, int address, char *label_name, int flags)
+{
+    label_table *label;
+
+    /* Check if label is already defined in the table */
+    if (find_label(symbols, label_name) != NULL)
+    {/* Label already exists in the table */
+        print_error(ERROR_11, AM_FILE_STAGE);
+        return;
     }
 
-    /* 'lines' - Points to the next empty line */
-    *table = safe_realloc(*table, (*lines + 1) * sizeof(label_table));  /* +1 for the new line */
     /* Store values in table */
-    (*table + *lines)->address = address;
-    (*table + *lines)->label = label_name;
-    (*table + *lines)->type = type;
-    (*table + *lines)->secondary_type = secondary_type;
-    /* Increase the number of lines in the table (for the next insertion) */
-    (*lines)++;
+    symbols->labels = grow_table(symbols->labels, &symbols->capacity, symbols->lines + 1, sizeof(label_table));
+    label = &symbols->labels[symbols->lines++];
+    label->label = label_name;
+    label->address = address;
+    label->flags = (unsigned char)flags;
+
+    if (2 * symbols->lines > symbols->hash_size)
+    {/* The hash index is more than half full => double it and rebuild it (the estimation of the number of labels was too small) */
+        symbols->hash_size *= 2;
+        build_symbol_hash_index(symbols);
+    }
+    else
+        /* Index the new label */
+        index_label(symbols, symbols->lines - 1);
+}
+
+char *add_to_name_pool(symbol_table *symbols, char *name)
+{
+    int size = strlen(name) + 1;  /* +1 for '\0' */
+    char *block;
+
+    if (symbols->name_pool == NULL || symbols->name_pool_used + size > NAME_POOL_BLOCK_SIZE)
+    {/* No room in the current block => allocate a new block (it starts with a pointer to the previous block) */
+        block = safe_malloc(NAME_POOL_BLOCK_SIZE);
+        memcpy(block, &symbols->name_pool, sizeof(char *));
+        symbols->name_pool = block;
+        symbols->name_pool_used = sizeof(char *);
+    }
+    memcpy(symbols->name_pool + symbols->name_pool_used, name, size);
+    symbols->name_pool_used += size;
+    return symbols->name_pool + symbols->name_pool_used - size;
+}
+
+void add_entry_request(symbol_table *symbols, char *label_name)
+{
+    entry_request *request;
+
+    symbols->entry_requests = grow_table(symbols->entry_requests, &symbols->entry_requests_capacity, symbols->entry_requests_lines + 1, sizeof(entry_request));
+    request = symbols->entry_requests + symbols->entry_requests_lines++;
+    request->label = label_name;
+    request->line_number = current_line_number;
 }
 
 /* A single function is sufficient as both operations are identical */
-void add_to_entries_externs_table(general_table **table, int address, char *label_name, int *lines)
+void add_to_entries_externs_table(general_table **table, int address, char *label_name, int *lines, int *capacity)
 {
     /* 'lines' - Points to the next empty line */
-    *table = safe_realloc(*table, (*lines + 1) * sizeof(general_table));  /* +1 for the new line */
+    *table = grow_table(*table, capacity, *lines + 1, sizeof(general_table));
     /* Store values in table */
     (*table + *lines)->address = address;
     (*table + *lines)->label = label_name;
@@ -77,41 +275,73 @@ void add_to_entries_externs_table(general_table **table, int address, char *labe
     (*lines)++;
 }
 
-void update_label_table_cells_of_type_data(label_table **table, int ICF, int lines)
+void free_symbol_table(symbol_table *symbols)
 {
     int i;
-    for (i = 0; i < lines; i++)
-    {/* Go over label table and add ICF to the address of data type lines */
-        /* [(*table + i)->type != NULL] - Is checked in order to deal with an external (because it's 'type' is NULL) */
-        if ((*table + i)->type != NULL && strcmp((*table + i)->type, DATA_TYPE) == 0)
-        {
-            (*table + i)->address += ICF;
-        }
+    char *block;
+    for (i = 0; i < symbols->entry_requests_lines; i++)
+        /* The label names of the .entry directives are not used by any other table */
+        free(symbols->entry_requests[i].label);
+    free(symbols->entry_requests);
+    if (symbols->forward_references != NULL)
+    {/* Single pass mode */
+        free_symbol_table(symbols->forward_references);
+        free(symbols->forward_references);
+        symbols->forward_references = NULL;
     }
+    while (symbols->name_pool != NULL)
+    {/* Stream mode => free the blocks of the label names (each block points to the previous one) */
+        block = symbols->name_pool;
+        memcpy(&symbols->name_pool, block, sizeof(char *));
+        free(block);
+    }
+    free(symbols->labels);
+    free(symbols->hash_index);
+    symbols->labels = NULL;
+    symbols->hash_index = NULL;
+    symbols->entry_requests = NULL;
+    symbols->lines = symbols->capacity = 0;
+    symbols->entry_requests_lines = symbols->entry_requests_capacity = 0;
 }
 
-void print_label_table_cells(label_table *table, int lines)
+void update_label_table_cells_of_type_data(symbol_table *symbols, int ICF)
 {
     int i;
-    for (i = 0; i < lines; i++)
+    label_table *table = symbols->labels;
+    for (i = 0; i < symbols->lines; i++)
+        /* Go over label table and add ICF to the address of data type lines (an external has no data flag) */
+        if (table[i].flags & DATA_FLAG)
+            table[i].address += ICF;
+}
+
+void print_label_table_cells(symbol_table *symbols)
+{
+    int i;
+    label_table *table = symbols->labels;
+    for (i = 0; i < symbols->lines; i++)
     {/* Go over label table and print its lines */
         printf("Label:       %3d | %5s", (table + i)->address, (table + i)->label);
-        printf(" | %7s  | %s\n", (table + i)->type, (table + i)->secondary_type);
+        printf(" | %s%s%s%s\n", ((table + i)->flags & CODE_FLAG) ? "code " : "", ((table + i)->flags & DATA_FLAG) ? "data " : "",
+               ((table + i)->flags & ENTRY_FLAG) ? "entry " : "", ((table + i)->flags & EXTERN_FLAG) ? "external" : "");
     }
 }
 
-void print_code_data_table_cells(code_data_array *table, int counter)
+void print_code_data_table_cells(word_store *table, int first_address)
 {
-    int i, bin_num;
-    char word_in_binary[WORD_SIZE];
+    int i, bit, address = first_address, run = 0;
 
-    for (i = 0; i < counter; i++)
-    {/* Go over code/data table and print its lines (manually convert to its machine code) */
-        bin_num = 0;
-        integer_to_binary((table + i)->machine_code, word_in_binary, &bin_num);
-        add_zeros(word_in_binary, &bin_num, WORD_SIZE - bin_num);
-        reverse_string(word_in_binary);
-        printf("Address: %3d | Machine Code: %s\n", (table + i)->address, word_in_binary);
+    for (i = 0; i < table->lines; i++)
+    {/* Go over code/data table and print its lines (print the bits of its machine code from the most significant bit) */
+        printf("Address: %3d | Machine Code: ", address);
+        for (bit = WORD_SIZE - 1; bit >= 0; bit--)
+            putchar((table->words[i] >> bit) & 1 ? '1' : '0');
+        if (run < table->runs_lines && table->runs[run].index == i)
+        {/* The line is a run of words */
+            printf(" (x%d)", table->runs[run].repeat_count);
+            address += table->runs[run++].repeat_count - 1;
+        }
+        putchar('\n');
+        address++;
     }
 }
 
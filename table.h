@@ -5,76 +5,291 @@
 #include "first_pass.h"
 
 /**
- * Adds a new line to the code table with the provided machine code and label.
+ * Makes sure that a table (that grows geometrically) has space for a number of lines.
+ * When the table is full, its capacity is doubled (starting from INITIAL_WORD_STORE_CAPACITY).
  *
  * Input:
- *   - code: Double pointer to the code table array
+ *   - table: The table (NULL if it was never allocated)
+ *   - capacity: Pointer to the number of allocated lines (it is updated)
+ *   - needed_lines: Number of lines that the table needs to have
+ *   - line_size: The size of a line (in bytes)
+ *
+ * Output:
+ *   - Returns the table (it may have moved)
+ */
+void *grow_table(void *table, int *capacity, int needed_lines, int line_size);
+
+
+/**
+ * Adds words to the end of a code/data table (the new words are not initialized).
+ *
+ * Input:
+ *   - store: Pointer to the table
+ *   - num_of_lines: Number of words to add
+ *
+ * Output:
+ *   - Returns a pointer to the first new word (it is valid until words are added again)
+ */
+int *add_lines_to_word_store(word_store *store, int num_of_lines);
+
+
+/**
+ * Frees the words and the side tables of a code/data table, and makes it empty.
+ *
+ * Input:
+ *   - store: Pointer to the table
+ *
+ * Output:
+ *   - No return value
+ */
+void free_word_store(word_store *store);
+
+
+/**
+ * Adds a new word to the code table with the provided machine code.
+ *
+ * Input:
+ *   - code: Pointer to the code table
+ *   - IC: Pointer to the instruction counter
+ *   - word: The encoded machine code word
+ *
+ * Output:
+ *   - No return value
+ */
+void add_to_code_table(word_store *code, int *IC, int word);
+
+
+/**
+ * Adds an empty word to the code table, and a fixup record for it (the word is encoded in the second pass).
+ *
+ * Input:
+ *   - code: Pointer to the code table
  *   - IC: Pointer to the instruction counter
- *   - word_in_binary: String containing the binary representation of the machine code
- *   - label: String containing the label associated with this code (can be NULL)
+ *   - label: String containing the label name that the word references (without '&')
+ *   - kind: The addressing mode of the operand (DIRECT_ADDRESSING_MODE or RELATIVE_ADDRESSING_MODE)
  *
  * Output:
  *   - No return value
  */
-void add_to_code_table(code_data_array **code, int *IC, char *word_in_binary, char *label);
+void add_fixup_to_code_table(word_store *code, int *IC, char *label, int kind);
 
 
 /**
  * Adds a new line to the data table with the provided binary representation.
  *
  * Input:
- *   - data: Double pointer to the data table array
+ *   - data: Pointer to the data table
  *   - DC: Pointer to the data counter
- *   - word_in_binary: String containing the binary representation of the data
+ *   - word: The encoded data word
  *
  * Output:
  *   - No return value
  */
-void add_to_data_table(code_data_array **data, int *DC, char *word_in_binary);
+void add_to_data_table(word_store *data, int *DC, int word);
 
 
 /**
- * Adds a new line to the label table with the provided information.
+ * Adds a number of new (zero) lines to the data table in one step.
  *
  * Input:
- *   - table: Double pointer to the label table
+ *   - data: Pointer to the data table
+ *   - DC: Pointer to the data counter (it is advanced by num_of_cells)
+ *   - num_of_cells: Number of lines to add
+ *
+ * Output:
+ *   - Returns a pointer to the first new word in the data table
+ */
+int *add_cells_to_data_table(word_store *data, int *DC, int num_of_cells);
+
+
+/**
+ * Adds a run of identical words (.space/.fill) to the data table as a single line (and a line in the runs side table).
+ * The run is expanded only when the object file is written, so its size does not affect the memory and time of the assembly.
+ *
+ * Input:
+ *   - data: Pointer to the data table
+ *   - DC: Pointer to the data counter (it is advanced by repeat_count)
+ *   - word: The encoded data word
+ *   - repeat_count: Number of words in the run
+ *
+ * Output:
+ *   - No return value
+ */
+void add_run_to_data_table(word_store *data, int *DC, int word, int repeat_count);
+
+
+/**
+ * Saves the first address of the words of the current line in the data table (for the listing file).
+ *
+ * Input:
+ *   - data: Pointer to the data table
+ *   - address: The data counter before the line was encoded
+ *
+ * Output:
+ *   - No return value
+ */
+void add_line_address(word_store *data, int address);
+
+
+/**
+ * Adds a new (empty) line to the instruction table.
+ *
+ * Input:
+ *   - table: Double pointer to the instruction table
+ *   - lines: Pointer to the counter of lines in the instruction table
+ *   - capacity: Pointer to the number of allocated lines in the instruction table
+ *
+ * Output:
+ *   - Returns a pointer to the new line in the instruction table (it is valid until lines are added again)
+ */
+encoded_instruction *add_to_instruction_table(encoded_instruction **table, int *lines, int *capacity);
+
+
+/**
+ * Frees the instruction table together with the operands and labels saved in its lines.
+ *
+ * Input:
+ *   - table: Pointer to the instruction table
+ *   - lines: Number of lines in the instruction table
+ *
+ * Output:
+ *   - No return value
+ */
+void free_instruction_table(encoded_instruction *table, int lines);
+
+
+/**
+ * Initializes an empty symbol table.
+ * The hash index is sized from an estimation of the number of labels (it grows if the estimation is too small).
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *   - estimated_num_of_labels: Estimation of the number of labels that will be added
+ *
+ * Output:
+ *   - No return value
+ */
+void init_symbol_table(symbol_table *symbols, int estimated_num_of_labels);
+
+
+/**
+ * Builds the hash index of the symbol table (of size 'hash_size') from the labels in the label table.
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *
+ * Output:
+ *   - No return value
+ */
+void build_symbol_hash_index(symbol_table *symbols);
+
+
+/**
+ * Inserts a line of the label table into the hash index of the symbol table (using linear probing).
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *   - line: The line of the label in the label table
+ *
+ * Output:
+ *   - No return value
+ */
+void index_label(symbol_table *symbols, int line);
+
+
+/**
+ * Finds a label in the symbol table by its name (a lookup in the hash index).
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *   - label_name: The name of the label
+ *
+ * Output:
+ *   - Returns a pointer to the line of the label in the label table (it is valid until labels are added)
+ *   - Returns NULL if the label is not in the table
+ */
+label_table *find_label(symbol_table *symbols, char *label_name);
+
+
+/**
+ * Adds a new line to the label table with the provided information (and indexes it).
+ * Prints an error if the label is already defined.
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
  *   - address: Memory address associated with the label
  *   - label_name: String containing the name of the label
- *   - type: String indicating the label type (code/data)
- *   - secondary_type: String containing additional type information (entry/extern)
- *   - lines: Pointer to the counter of lines in the label table
+ *   - flags: The attributes of the label (CODE_FLAG, DATA_FLAG, EXTERN_FLAG, ... combined with '|')
+ *
+ * Output:
+ *   - No return value
+ */
+void add_to_label_table(symbol_table *symbols, int address, char *label_name, int flags);
+
+
+/**
+ * Copies a label name to the pool of label names of the symbol table (stream mode).
+ * The names are packed in large blocks that are freed with the symbol table, so a name costs only its length.
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *   - name: The label name (shorter than NAME_POOL_BLOCK_SIZE)
+ *
+ * Output:
+ *   - Returns a pointer to the copy of the name
+ */
+char *add_to_name_pool(symbol_table *symbols, char *name);
+
+
+/**
+ * Saves a .entry directive of the current line in the symbol table (it is applied in the second pass).
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
+ *   - label_name: String containing the name of the entry label (it is freed with the symbol table)
+ *
+ * Output:
+ *   - No return value
+ */
+void add_entry_request(symbol_table *symbols, char *label_name);
+
+
+/**
+ * Frees the label table, the hash index, the .entry directives and the forward references of the symbol table
+ * (only the label names of the .entry directives are freed).
+ *
+ * Input:
+ *   - symbols: Pointer to the symbol table
  *
  * Output:
  *   - No return value
  */
-void add_to_label_table(label_table **table, int address, char *label_name, char *type, char *secondary_type, int *lines);
+void free_symbol_table(symbol_table *symbols);
 
 
 /**
  * Updates the address values of all data-type labels by adding the final instruction count (ICF).
  *
  * Input:
- *   - table: Double pointer to the label table
+ *   - symbols: Pointer to the symbol table
  *   - ICF: Final instruction counter value from first pass
- *   - lines: Number of lines in the label table
  *
  * Output:
  *   - No return value
  */
-void update_label_table_cells_of_type_data(label_table **table, int ICF, int lines);
+void update_label_table_cells_of_type_data(symbol_table *symbols, int ICF);
 
 
 /**
  * Prints all lines in the label table with their details.
  *
  * Input:
- *   - table: Pointer to the label table
- *   - lines: Number of lines in the label table
+ *   - symbols: Pointer to the symbol table
  *
  * Output:
  *   - No return value
  */
-void print_label_table_cells(label_table *table, int lines);
+void print_label_table_cells(symbol_table *symbols);
 
 
 /**
@@ -82,12 +297,12 @@ void print_label_table_cells(label_table *table, int lines);
  *
  * Input:
  *   - table: Pointer to the code/data table
- *   - counter: Number of lines in the table
+ *   - first_address: The address of the first word of the table
  *
  * Output:
  *   - No return value
  */
-void print_code_data_table_cells(code_data_array *table, int counter);
+void print_code_data_table_cells(word_store *table, int first_address);
 
 
 /**
@@ -98,11 +313,12 @@ void print_code_data_table_cells(code_data_array *table, int counter);
  *   - address: Memory address associated with the label
  *   - label_name: String containing the name of the label
  *   - lines: Pointer to the counter of lines in the table
+ *   - capacity: Pointer to the number of allocated lines in the table (the table grows with grow_table)
  *
  * Output:
  *   - No return value
  */
-void add_to_entries_externs_table(general_table **table, int address, char *label_name, int *lines);
+void add_to_entries_externs_table(general_table **table, int address, char *label_name, int *lines, int *capacity);
 
 
 /**